@@ -24,6 +24,12 @@
 //										  override the default. In pure ISO mode, anything other than
 //										  single_threaded will cause a compiler error.
 //
+//			SIGSLOT_INLINE_CONNECTIONS	- Number of connections a signal stores inline before its connection
+//										  array moves to the heap. Defaults to 4.
+//
+//			SIGSLOT_LOCK_STRIPES		- Number of mutexes shared by all multi_threaded_striped objects.
+//										  Defaults to 64.
+//
 //		PLATFORM NOTES
 //
 //			Win32						- On Win32, the WIN32 symbol must be #defined. Most mainstream
@@ -69,6 +75,32 @@
 //										  absolutely essential. However, on some platforms, creating a lot of 
 //										  mutexes can slow down the whole OS, so use this option with care.
 //
+//			multi_threaded_striped		- Each signal and has_slots locks one of a fixed pool of SIGSLOT_LOCK_STRIPES
+//										  cache-line padded mutexes, picked by hashing its address. Contention is
+//										  close to multi_threaded_local, but objects carry no mutex at all.
+//										  Unrelated objects sharing a stripe serialise against each other.
+//										  A signal and its receivers are locked together in stripe order, so
+//										  connecting and disconnecting cannot deadlock on stripes they share
+//										  with unrelated objects. An emission copies the connections under its
+//										  stripe and calls the slots from the copy with no stripe held, so
+//										  slots may connect, disconnect and emit anything. A slot disconnected
+//										  meanwhile is skipped; one already running is not interrupted, but a
+//										  receiver's own disconnect, and so its destructor, waits for it.
+//
+//			multi_threaded_spin			- Like multi_threaded_local, with a test-and-test-and-set spin lock that
+//										  backs off exponentially. Suits short critical sections.
+//
+//			multi_threaded_adaptive		- Like multi_threaded_local, with a lock that spins briefly before
+//										  sleeping in the OS mutex. Suits critical sections of varying length.
+//
+//			multi_threaded_shared		- (C++17) Emitters share a std::shared_mutex; connect and disconnect take it
+//										  exclusively. Suits emit-dominated signals, but a slot must not
+//										  connect to, disconnect from or emit the signal that is calling it.
+//
+//			The policy is a template argument: basic_signals<mt_policy, args...> and
+//			basic_has_slots<mt_policy>. signals<args...> and has_slots use SIGSLOT_DEFAULT_MT_POLICY.
+//			A signal can only connect to receivers that share its policy.
+//
 //		USING THE LIBRARY
 //
 //			See the full documentation at http://sigslot.sourceforge.net/
@@ -95,288 +127,5133 @@
 #ifndef SIGSLOT_HPP
 #define SIGSLOT_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#if __cplusplus >= 201703L
+#	include <memory_resource>
+#endif
+
+#ifndef SIGSLOT_PURE_ISO
+#	include <condition_variable>
+#	include <deque>
+#	include <exception>
+#	include <mutex>
+#	include <thread>
+#	if __cplusplus >= 201703L
+#		include <shared_mutex>
+#	endif
+#	if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#		include <intrin.h>
+#	endif
+#endif
+
+#ifndef SIGSLOT_INLINE_CONNECTIONS
+#	define SIGSLOT_INLINE_CONNECTIONS 4
+#endif
+
+#ifndef SIGSLOT_LOCK_STRIPES
+#	define SIGSLOT_LOCK_STRIPES 64
+#endif
+
+#ifndef SIGSLOT_DEFAULT_MT_POLICY
+#	ifdef SIGSLOT_PURE_ISO
+#		define SIGSLOT_DEFAULT_MT_POLICY single_threaded
+#	else
+#		define SIGSLOT_DEFAULT_MT_POLICY multi_threaded_global
+#	endif
+#endif
+
 namespace sigslot 
 {
-	template<class LockPolicy = std::mutex>
-	struct StaticGuard
+	// Where signals allocate their connection arrays and connection links. With C++17 this
+	// is std::pmr::memory_resource, so pool and monotonic resources plug straight in;
+	// otherwise a stand-in with the same interface.
+#if __cplusplus >= 201703L
+	typedef std::pmr::memory_resource memory_resource;
+
+	inline memory_resource* get_default_resource() {
+		return std::pmr::get_default_resource();
+	}
+
+	// For what other threads free without the signal's lock: always the heap, as a
+	// resource need not be thread-safe.
+	inline memory_resource* _heap_resource() {
+		return std::pmr::new_delete_resource();
+	}
+#else
+	class memory_resource
 	{
-		LockPolicy mutex;
+	public:
+		virtual ~memory_resource() {}
 
-		StaticGuard() {
-			mutex.try_lock();
+		void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t)) {
+			return do_allocate(bytes, alignment);
 		}
 
-		explicit StaticGuard(LockPolicy *mtx)
-			: mutex(&mtx) 
-		{
-			mutex.try_lock();
+		void deallocate(void* p, std::size_t bytes, std::size_t alignment = alignof(std::max_align_t)) {
+			do_deallocate(p, bytes, alignment);
 		}
 
-		~StaticGuard() {
-			mutex.unlock();
+		bool is_equal(const memory_resource& other) const noexcept {
+			return do_is_equal(other);
 		}
+
+	protected:
+		virtual void* do_allocate(std::size_t bytes, std::size_t alignment) = 0;
+		virtual void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) = 0;
+		virtual bool do_is_equal(const memory_resource& other) const noexcept = 0;
 	};
 
-	class has_slots;
+	class _new_delete_resource : public memory_resource
+	{
+	protected:
+		virtual void* do_allocate(std::size_t bytes, std::size_t) {
+			return ::operator new(bytes);
+		}
 
-	template<typename... args_type>
-	struct _connection_bases
+		virtual void do_deallocate(void* p, std::size_t, std::size_t) {
+			::operator delete(p);
+		}
+
+		virtual bool do_is_equal(const memory_resource& other) const noexcept {
+			return this == &other;
+		}
+	};
+
+	inline memory_resource* get_default_resource()
+	{
+		static _new_delete_resource g_resource;
+		return &g_resource;
+	}
+
+	inline memory_resource* _heap_resource() {
+		return get_default_resource();
+	}
+#endif
+
+	// Gives up the processor while spinning on another thread.
+	inline void _yield()
+	{
+#ifndef SIGSLOT_PURE_ISO
+		std::this_thread::yield();
+#endif
+	}
+
+	// Threading policies. Signals and has_slots derive from their policy, so a stateless
+	// policy costs no space and its lock()/unlock() compile away entirely.
+	class single_threaded
+	{
+	public:
+		void lock() {}
+		bool try_lock() { return true; }
+		void unlock() {}
+	};
+
+#ifndef SIGSLOT_PURE_ISO
+	class multi_threaded_global
+	{
+	public:
+		void lock() {
+			get_mutex().lock();
+		}
+
+		bool try_lock() {
+			return get_mutex().try_lock();
+		}
+
+		void unlock() {
+			get_mutex().unlock();
+		}
+
+	private:
+		static std::recursive_mutex& get_mutex() {
+			static std::recursive_mutex g_mutex;
+			return g_mutex;
+		}
+	};
+
+	class multi_threaded_local
 	{
-		virtual has_slots* getdest() const = 0;
-		virtual void emit(args_type...) = 0;
-		virtual _connection_bases<args_type...>* clone() = 0;
-		virtual _connection_bases<args_type...>* duplicate(has_slots* pnewdest) = 0;
+		std::recursive_mutex m_mutex;
+
+	public:
+		multi_threaded_local()
+		{}
+
+		// Each object owns its mutex; copies get a fresh one.
+		multi_threaded_local(const multi_threaded_local&)
+		{}
+
+		multi_threaded_local& operator=(const multi_threaded_local&) {
+			return *this;
+		}
+
+		void lock() {
+			m_mutex.lock();
+		}
+
+		bool try_lock() {
+			return m_mutex.try_lock();
+		}
+
+		void unlock() {
+			m_mutex.unlock();
+		}
 	};
 
-	struct _signal_base {
-		virtual void slot_disconnect(has_slots* pslot) = 0;
-		virtual void slot_duplicate(const has_slots* poldslot, has_slots* pnewslot) = 0;
+	// No per-object state: the object's address picks its mutex from a static pool.
+	class multi_threaded_striped
+	{
+	public:
+		void lock() {
+			stripe().lock();
+		}
+
+		bool try_lock() {
+			return stripe().try_lock();
+		}
+
+		void unlock() {
+			stripe().unlock();
+		}
+
+		// Objects sharing a stripe share a key; _ordered_guard takes stripes in key order.
+		const void* lock_key() const {
+			return &stripe();
+		}
+
+	private:
+		struct alignas(64) padded_mutex
+		{
+			std::recursive_mutex m_mutex;
+		};
+
+		std::recursive_mutex& stripe() const
+		{
+			static padded_mutex g_stripes[SIGSLOT_LOCK_STRIPES];
+
+			// Fibonacci hashing spreads the aligned addresses of neighbouring objects.
+			std::uint64_t hash = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(this)) * 0x9E3779B97F4A7C15ull;
+			return g_stripes[(hash >> 32) % SIGSLOT_LOCK_STRIPES].m_mutex;
+		}
 	};
 
-	class has_slots
+	// Tells the processor this thread is busy-waiting.
+	inline void _cpu_relax()
 	{
-		typedef std::set<_signal_base *> sender_set;
-		typedef typename sender_set::const_iterator const_iterator;
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+		_mm_pause();
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__i386__) || defined(__x86_64__))
+		__builtin_ia32_pause();
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+		__asm__ __volatile__("yield");
+#endif
+	}
 
-		sender_set m_senders;
+	// Test-and-test-and-set lock. Waiters spin on a plain load, so the line stays shared
+	// until the holder releases it, and back off exponentially between attempts; past the
+	// longest back-off they yield the processor.
+	class _spin_mutex
+	{
+		std::atomic<bool> m_locked;
 
 	public:
-		has_slots()
+		_spin_mutex()
+			: m_locked(false)
 		{}
 
-		has_slots(const has_slots& hs)
+		bool try_lock() {
+			return !m_locked.load(std::memory_order_relaxed) && !m_locked.exchange(true, std::memory_order_acquire);
+		}
+
+		void lock()
 		{
-			StaticGuard<> guard();
-			typename const_iterator it = hs.m_senders.begin();
-			typename const_iterator itEnd = hs.m_senders.end();
+			unsigned backoff = 1;
 
-			while (it != itEnd)
+			while (!try_lock())
 			{
-				(*it)->slot_duplicate(&hs, this);
-				m_senders.insert(*it);
-				++it;
+				while (m_locked.load(std::memory_order_relaxed))
+				{
+					if (backoff > 1024) {
+						_yield();
+						continue;
+					}
+
+					for (unsigned i = 0; i < backoff; ++i) {
+						_cpu_relax();
+					}
+
+					backoff *= 2;
+				}
 			}
 		}
 
-		void signal_connect(_signal_base* sender) {
-			StaticGuard<> guard();
-			m_senders.insert(sender);
+		void unlock() {
+			m_locked.store(false, std::memory_order_release);
 		}
+	};
 
-		void signal_disconnect(_signal_base* sender) {
-			StaticGuard<> guard();
-			m_senders.erase(sender);
-		}
+	// Spins briefly on try_lock, with the same back-off, before blocking in the OS mutex
+	// (a futex on Linux). Short critical sections never sleep; long ones don't burn a core.
+	class _adaptive_mutex
+	{
+		std::mutex m_mutex;
 
-		virtual ~has_slots() {
-			disconnect_all();
+	public:
+		bool try_lock() {
+			return m_mutex.try_lock();
 		}
 
-		void disconnect_all()
+		void lock()
 		{
-			StaticGuard<> guard();
-			const_iterator it = m_senders.begin();
-			const_iterator itEnd = m_senders.end();
+			for (unsigned backoff = 1; backoff <= 1024; backoff *= 2)
+			{
+				if (m_mutex.try_lock()) {
+					return;
+				}
 
-			while (it != itEnd) {
-				(*it)->slot_disconnect(this);
-				++it;
+				for (unsigned i = 0; i < backoff; ++i) {
+					_cpu_relax();
+				}
 			}
 
-			m_senders.erase(m_senders.begin(), m_senders.end());
+			m_mutex.lock();
+		}
+
+		void unlock() {
+			m_mutex.unlock();
 		}
 	};
 
-	template<class... args_type>
-	struct _signal_bases : public _signal_base
+	// Makes a non-recursive mutex recursive, as the policies must be: slots may connect
+	// and disconnect on the signal that is calling them, and receivers lock themselves
+	// again while being connected. Only the owning thread can find its own id in m_owner.
+	template<class mutex_type>
+	class _recursive_mutex
 	{
-		typedef std::list<_connection_bases<args_type...> *> connections_list;
-		typename connections_list m_connected_slots;
+	protected:
+		mutex_type m_mutex;
+		std::atomic<std::thread::id> m_owner;
+		std::size_t m_depth;
+
+	public:
+		_recursive_mutex()
+			: m_owner(std::thread::id()), m_depth(0)
+		{}
 
-		_signal_bases()
+		// Each object owns its lock; copies get a fresh one.
+		_recursive_mutex(const _recursive_mutex&)
+			: m_owner(std::thread::id()), m_depth(0)
 		{}
 
-		_signal_bases(const _signal_bases<args_type...>& s)
+		_recursive_mutex& operator=(const _recursive_mutex&) {
+			return *this;
+		}
+
+		void lock()
+		{
+			std::thread::id self = std::this_thread::get_id();
+
+			if (m_owner.load(std::memory_order_relaxed) == self) {
+				++m_depth;
+				return;
+			}
+
+			m_mutex.lock();
+			m_owner.store(self, std::memory_order_relaxed);
+			m_depth = 1;
+		}
+
+		bool try_lock()
 		{
-			StaticGuard<> guard();
-			typename connections_list::const_iterator it = s.m_connected_slots.begin();
-			typename connections_list::const_iterator itEnd = s.m_connected_slots.end();
+			std::thread::id self = std::this_thread::get_id();
+
+			if (m_owner.load(std::memory_order_relaxed) == self) {
+				++m_depth;
+				return true;
+			}
+
+			if (!m_mutex.try_lock()) {
+				return false;
+			}
+
+			m_owner.store(self, std::memory_order_relaxed);
+			m_depth = 1;
+			return true;
+		}
 
-			while (it != itEnd)
+		void unlock()
+		{
+			if (--m_depth == 0)
 			{
-				(*it)->getdest()->signal_connect(this);
-				m_connected_slots.push_back((*it)->clone());
+				m_owner.store(std::thread::id(), std::memory_order_relaxed);
+				m_mutex.unlock();
+			}
+		}
+	};
+
+	// For short critical sections under light contention: a per-object spin lock.
+	class multi_threaded_spin : public _recursive_mutex<_spin_mutex>
+	{};
+
+	// For critical sections whose length varies: spins first, then sleeps.
+	class multi_threaded_adaptive : public _recursive_mutex<_adaptive_mutex>
+	{};
+
+#if __cplusplus >= 201703L
+	// For emit-dominated signals: emitters share a std::shared_mutex, and connect and
+	// disconnect take it exclusively. Because emitters share the lock, a slot must not
+	// connect to, disconnect from or emit the signal that is calling it. Receivers using
+	// this policy lock exclusively.
+	class multi_threaded_shared : public _recursive_mutex<std::shared_mutex>
+	{
+	public:
+		void lock_shared()
+		{
+			// Already held exclusively by this thread, which may be a connect running a
+			// nested emission; the exclusive hold covers it.
+			if (m_owner.load(std::memory_order_relaxed) != std::this_thread::get_id()) {
+				m_mutex.lock_shared();
+			}
+		}
+
+		void unlock_shared()
+		{
+			if (m_owner.load(std::memory_order_relaxed) != std::this_thread::get_id()) {
+				m_mutex.unlock_shared();
+			}
+		}
+	};
+#endif
+#endif
+
+	template<class mt_policy>
+	struct StaticGuard
+	{
+		mt_policy* m_mutex;
+
+		explicit StaticGuard(mt_policy* mtx)
+			: m_mutex(mtx) 
+		{
+			m_mutex->lock();
+		}
+
+		~StaticGuard() {
+			m_mutex->unlock();
+		}
+
+		StaticGuard(const StaticGuard&) = delete;
+		StaticGuard& operator=(const StaticGuard&) = delete;
+	};
+
+	// Whether unrelated objects may share a lock under mt_policy, each naming its lock
+	// with lock_key(), of which there are at most keys. A thread that holds one such lock
+	// and takes another can deadlock against a thread doing the same the other way round,
+	// whatever objects they lock.
+	template<class mt_policy>
+	struct _ordered_locking : std::false_type
+	{
+		static const std::size_t keys = 0;
+	};
+
+#ifndef SIGSLOT_PURE_ISO
+	template<>
+	struct _ordered_locking<multi_threaded_striped> : std::true_type
+	{
+		static const std::size_t keys = SIGSLOT_LOCK_STRIPES;
+	};
+#endif
+
+	// The objects an _ordered_guard locks, one per lock, in key order. Sized for every
+	// lock the policy has, so that gathering them never allocates.
+	template<class mt_policy>
+	class _lock_set
+	{
+		static const std::size_t capacity = _ordered_locking<mt_policy>::keys ? _ordered_locking<mt_policy>::keys : 1;
+
+		mt_policy* m_objects[capacity];
+		bool m_held[capacity];
+		std::size_t m_size;
+
+	public:
+		_lock_set()
+			: m_size(0)
+		{}
 
-				++it;
+		// Ignored if the set already has object's lock.
+		void add(mt_policy* object)
+		{
+			mt_policy** position = std::lower_bound(m_objects, m_objects + m_size, object, &key_order);
+			std::size_t i = static_cast<std::size_t>(position - m_objects);
+
+			if (i < m_size && key(m_objects[i]) == key(object)) {
+				return;
 			}
+
+			std::copy_backward(m_objects + i, m_objects + m_size, m_objects + m_size + 1);
+			std::copy_backward(m_held + i, m_held + m_size, m_held + m_size + 1);
+			m_objects[i] = object;
+			m_held[i] = false;
+			++m_size;
+		}
+
+		std::size_t size() const {
+			return m_size;
 		}
 
-		void slot_duplicate(const has_slots* oldtarget, has_slots* newtarget)
+		void lock()
 		{
-			StaticGuard<> guard();
-			typename connections_list::iterator it = m_connected_slots.begin();
-			typename connections_list::iterator itEnd = m_connected_slots.end();
+			for (std::size_t i = 0; i < m_size; ++i)
+			{
+				m_objects[i]->lock();
+				m_held[i] = true;
+			}
+		}
 
-			while (it != itEnd) 
+		// In reverse key order.
+		void unlock()
+		{
+			for (std::size_t i = m_size; i > 0; --i)
 			{
-				if ((*it)->getdest() == oldtarget) {
-					m_connected_slots.push_back((*it)->duplicate(newtarget));
+				if (m_held[i - 1])
+				{
+					m_objects[i - 1]->unlock();
+					m_held[i - 1] = false;
 				}
-
-				++it;
 			}
 		}
 
-		~_signal_bases() {
-			disconnect_all();
+	private:
+		// Collectors are compiled for every policy, though only called for these.
+		static const void* key(const mt_policy* object) {
+			return key(object, _ordered_locking<mt_policy>());
 		}
 
-		void disconnect_all()
+		static const void* key(const mt_policy* object, std::true_type) {
+			return object->lock_key();
+		}
+
+		static const void* key(const mt_policy* object, std::false_type) {
+			return object;
+		}
+
+		static bool key_order(const mt_policy* a, const mt_policy* b) {
+			return std::less<const void*>()(key(a), key(b));
+		}
+	};
+
+	// Locks a signal or receiver, with whatever it is about to lock as well, in an order
+	// that does not depend on which was reached first. first and second are always
+	// locked. Under an _ordered_locking policy, collect(objects) then names, with them
+	// locked, the other objects the operation will lock; if any of their locks is not
+	// held yet, everything is let go and taken again in key order with them included,
+	// until the set is complete. The operation's own StaticGuards then only recurse.
+	// A lock is found from the object's address alone, so an object that went away
+	// between rounds costs an unneeded lock and nothing more.
+	//
+	// Per-object locks can't be taken that way: an object that went away between rounds
+	// took its mutex with it. They follow a hierarchy instead, in which a signal comes
+	// before its receivers: the operation's StaticGuards lock receivers as they go, with
+	// the signal held. Anything else is only tried for, with the lock that was waited for
+	// held; if that fails, everything is let go and taken again. second is tried for
+	// that way, and so are the signals of a receiver (see basic_has_slots). collect is
+	// not called.
+	template<class mt_policy>
+	class _ordered_guard
+	{
+		mt_policy* m_first;
+		mt_policy* m_second;
+		_lock_set<mt_policy> m_locked; // under _ordered_locking, all held
+
+	public:
+		template<class collector>
+		_ordered_guard(mt_policy* first, mt_policy* second, collector collect)
+			: m_first(first), m_second(second)
 		{
-			StaticGuard<> guard();
-			typename connections_list::const_iterator it = m_connected_slots.begin();
-			typename connections_list::const_iterator itEnd = m_connected_slots.end();
+			lock(collect, _ordered_locking<mt_policy>());
+		}
 
-			while (it != itEnd)
+		_ordered_guard(mt_policy* first, mt_policy* second)
+			: _ordered_guard(first, second, &no_others)
+		{}
+
+		~_ordered_guard()
+		{
+			if (m_locked.size() == 0)
 			{
-				(*it)->getdest()->signal_disconnect(this);
-				delete *it;
+				if (m_second) {
+					m_second->unlock();
+				}
 
-				++it;
+				m_first->unlock();
+				return;
 			}
 
-			m_connected_slots.erase(m_connected_slots.begin(), m_connected_slots.end());
+			m_locked.unlock();
 		}
 
-		void disconnect(has_slots* pclass)
-		{
-			StaticGuard<> guard();
-			typename connections_list::iterator it = m_connected_slots.begin();
-			typename connections_list::iterator itEnd = m_connected_slots.end();
+		_ordered_guard(const _ordered_guard&) = delete;
+		_ordered_guard& operator=(const _ordered_guard&) = delete;
 
-			while (it != itEnd)
+	private:
+		template<class collector>
+		void lock(collector&, std::false_type)
+		{
+			for (;;)
 			{
-				if ((*it)->getdest() == pclass)
-				{
-					delete *it;
-					m_connected_slots.erase(it);
-					pclass->signal_disconnect(this);
+				m_first->lock();
+
+				if (!m_second || m_second->try_lock()) {
 					return;
 				}
 
-				++it;
+				m_first->unlock();
+				_yield();
 			}
 		}
 
-		void slot_disconnect(has_slots* pslot)
+		template<class collector>
+		void lock(collector& collect, std::true_type)
 		{
-			StaticGuard<> guard();
-			typename connections_list::iterator it = m_connected_slots.begin();
-			typename connections_list::iterator itEnd = m_connected_slots.end();
+			m_locked.add(m_first);
 
-			while (it != itEnd)
+			if (m_second) {
+				m_locked.add(m_second);
+			}
+
+			for (;;)
 			{
-				typename connections_list::iterator itNext = it;
-				++itNext;
+				m_locked.lock();
+				std::size_t held = m_locked.size();
+				collect(m_locked);
 
-				if ((*it)->getdest() == pslot) {
-					m_connected_slots.erase(it);
+				if (m_locked.size() == held) {
+					return;
 				}
 
-				it = itNext;
+				m_locked.unlock();
 			}
-		}  
+		}
+
+		static void no_others(_lock_set<mt_policy>&)
+		{}
 	};
 
-	template<class dest_type, typename... args_type>
-	class _connections : public _connection_bases<args_type...>
+	// Guards a few instructions' worth of state shared with the dispatching thread. Built
+	// on std::atomic alone, so queued connections work under any policy.
+	class _spin_flag
 	{
-		dest_type* m_pobject;
-		void (dest_type::* m_pmemfun)(args_type...);
+		std::atomic<bool> m_locked;
 
 	public:
-		_connections() {
-			m_pobject = nullptr;
-			m_pmemfun = nullptr;
-		}
+		_spin_flag()
+			: m_locked(false)
+		{}
 
-		_connections(dest_type* pobject, void (dest_type::*pmemfun)(args_type...)) {
-			m_pobject = pobject;
-			m_pmemfun = pmemfun;
+		void lock()
+		{
+			while (m_locked.exchange(true, std::memory_order_acquire))
+			{
+				while (m_locked.load(std::memory_order_relaxed)) {
+					_yield();
+				}
+			}
 		}
 
-		virtual _connection_bases<args_type...>* clone() {
-			return new _connections<dest_type, args_type...>(*this);
+		void unlock() {
+			m_locked.store(false, std::memory_order_release);
 		}
+	};
 
-		virtual _connection_bases<args_type...>* duplicate(has_slots* pnewdest) {
-			return new _connections<dest_type, args_type...>((dest_type *)pnewdest, m_pmemfun);
-		}
+	// A call captured by a queued connection, waiting in a dispatcher.
+	class _queued_call
+	{
+	public:
+		std::atomic<_queued_call*> m_next;
 
-		virtual void emit(args_type... args) {
-			(m_pobject->*m_pmemfun)(args...);
-		}
+		virtual ~_queued_call() {}
+		virtual void run() = 0;
 
-		virtual has_slots* getdest() const {
-			return m_pobject;
+		// Once run, or dropped with the dispatcher.
+		virtual void destroy() {
+			delete this;
 		}
 	};
 
-	template<typename... args_type>
-	class signals : public _signal_bases<args_type...>
+	// Runs queued slots on the thread that calls dispatch(). Any number of threads post
+	// into it through a lock-free intrusive MPSC queue; only the owning thread drains it.
+	// A dispatcher must outlive the connections queued to it, and pending calls that are
+	// never dispatched are destroyed with it.
+	class dispatcher
 	{
+		struct stub_call : public _queued_call
+		{
+			void run() {}
+		};
+
+		std::atomic<_queued_call*> m_head;
+		_queued_call* m_tail;
+		stub_call m_stub;
+
 	public:
-		signals()
-		{}
+		dispatcher()
+			: m_head(&m_stub), m_tail(&m_stub)
+		{
+			m_stub.m_next.store(nullptr, std::memory_order_relaxed);
+		}
 
-		signals(const signals<args_type...>& s)
-			: _signal_bases<args_type...>(s)
-		{}
+		~dispatcher()
+		{
+			while (_queued_call* call = pop()) {
+				call->destroy();
+			}
+		}
+
+		dispatcher(const dispatcher&) = delete;
+		dispatcher& operator=(const dispatcher&) = delete;
+
+		// Runs the calls queued so far, in the order they were posted, and returns how many
+		// ran. A call whose post is still in progress on another thread is left for the
+		// next dispatch().
+		std::size_t dispatch()
+		{
+			std::size_t count = 0;
+
+			while (_queued_call* call = pop())
+			{
+				call->run();
+				call->destroy();
+				++count;
+			}
+
+			return count;
+		}
 
-		template<class desttype>
-		void connect(desttype* pclass, void (desttype::* pmemfun)(args_type...))
+		// Any thread.
+		void post(_queued_call* call)
 		{
-			StaticGuard<> guard();
-			_connections<desttype, args_type...>* conn = new _connections<desttype, args_type...>(pclass, pmemfun);
-			_signal_bases<args_type...>::m_connected_slots.push_back(conn);
-			pclass->signal_connect(this);
+			call->m_next.store(nullptr, std::memory_order_relaxed);
+			_queued_call* prev = m_head.exchange(call, std::memory_order_acq_rel);
+			prev->m_next.store(call, std::memory_order_release);
 		}
 
-		void emit(args_type... args)
+	private:
+		_queued_call* pop()
 		{
-			StaticGuard<> guard();
-			typename _signal_bases<args_type...>::connections_list::const_iterator itNext, it = _signal_bases<args_type...>::m_connected_slots.begin();
-			typename _signal_bases<args_type...>::connections_list::const_iterator itEnd = _signal_bases<args_type...>::m_connected_slots.end();
+			_queued_call* tail = m_tail;
+			_queued_call* next = tail->m_next.load(std::memory_order_acquire);
 
-			while (it != itEnd)
+			if (tail == &m_stub)
 			{
-				itNext = it;
-				++itNext;
+				if (!next) {
+					return nullptr;
+				}
+
+				m_tail = next;
+				tail = next;
+				next = next->m_next.load(std::memory_order_acquire);
+			}
+
+			if (next) {
+				m_tail = next;
+				return tail;
+			}
+
+			if (tail != m_head.load(std::memory_order_acquire)) {
+				return nullptr;
+			}
 
-				(*it)->emit(args...);
+			// tail is the last call; park the stub behind it so tail can be handed out.
+			post(&m_stub);
+			next = tail->m_next.load(std::memory_order_acquire);
 
-				it = itNext;
+			if (next) {
+				m_tail = next;
+				return tail;
 			}
+
+			return nullptr;
 		}
+	};
+
+#ifndef SIGSLOT_PURE_ISO
+	// Worker threads for emit_parallel(). parallel_for() splits a range into chunks and
+	// deals them out across per-worker queues; each worker takes from the back of its own
+	// queue and steals from the front of the others' when it runs dry. The calling thread
+	// takes chunks too while it waits, so a slot may itself call parallel_for().
+	//
+	// Emissions smaller than threshold run inline on the calling thread; larger ones are
+	// cut into chunks of at least grain connections.
+	class thread_pool
+	{
+		struct job
+		{
+			std::atomic<std::size_t> m_remaining;
+			std::atomic<bool> m_failed;
+			std::exception_ptr m_error;
+
+			job()
+				: m_remaining(0), m_failed(false)
+			{}
+
+			virtual ~job() {}
+			virtual void run(std::size_t first, std::size_t last) = 0;
+		};
+
+		template<class function>
+		struct function_job : public job
+		{
+			function& m_function;
+
+			explicit function_job(function& f)
+				: m_function(f)
+			{}
+
+			void run(std::size_t first, std::size_t last) {
+				m_function(first, last);
+			}
+		};
+
+		struct task
+		{
+			job* m_job;
+			std::size_t m_first;
+			std::size_t m_last;
+		};
+
+		// Padded so that neighbouring queues' locks don't share a cache line.
+		struct task_queue
+		{
+			std::mutex m_mutex;
+			std::deque<task> m_tasks;
+			char m_padding[64];
+		};
+
+		std::size_t m_threshold;
+		std::size_t m_grain;
+		std::size_t m_count; // fixed before any worker starts
+		std::unique_ptr<task_queue[]> m_queues;
+		std::vector<std::thread> m_threads;
+		std::atomic<std::size_t> m_pending;
+		std::mutex m_sleep_mutex;
+		std::condition_variable m_wake;
+		bool m_stop;
 
-		void operator()(args_type... args)
+	public:
+		// threads defaults to one fewer than the hardware threads, the caller being the last.
+		explicit thread_pool(unsigned threads = default_threads(), std::size_t threshold = 1024, std::size_t grain = 256)
+			: m_threshold(threshold), m_grain(grain ? grain : 1), m_count(threads), m_queues(new task_queue[threads ? threads : 1]),
+			  m_pending(0), m_stop(false)
 		{
-			StaticGuard<> guard();
-			typename _signal_bases<args_type...>::connections_list::const_iterator itNext, it = _signal_bases<args_type...>::m_connected_slots.begin();
-			typename _signal_bases<args_type...>::connections_list::const_iterator itEnd = _signal_bases<args_type...>::m_connected_slots.end();
+			for (unsigned i = 0; i < threads; ++i) {
+				m_threads.emplace_back(&thread_pool::work, this, i);
+			}
+		}
 
-			while (it != itEnd)
+		~thread_pool()
+		{
 			{
-				itNext = it;
-				++itNext;
+				std::lock_guard<std::mutex> lock(m_sleep_mutex);
+				m_stop = true;
+			}
 
-				(*it)->emit(args...);
+			m_wake.notify_all();
 
-				it = itNext;
+			for (std::size_t i = 0; i < m_threads.size(); ++i) {
+				m_threads[i].join();
 			}
 		}
-	};
 
-}
-#endif // SIGSLOT_HPP
+		thread_pool(const thread_pool&) = delete;
+		thread_pool& operator=(const thread_pool&) = delete;
 
+		std::size_t threshold() const { return m_threshold; }
+		std::size_t size() const { return m_count; }
+
+		// Calls f(first, last) over disjoint subranges covering [0, count) and returns when
+		// all have finished. The first exception thrown by f is rethrown here, once every
+		// chunk has run; the rest of the throwing chunk is skipped.
+		template<class function>
+		void parallel_for(std::size_t count, function f)
+		{
+			std::size_t chunk = (count + 4 * (m_count + 1) - 1) / (4 * (m_count + 1));
+
+			if (chunk < m_grain) {
+				chunk = m_grain;
+			}
+
+			if (m_count == 0 || count <= chunk) {
+				f(0, count);
+				return;
+			}
+
+			function_job<function> pending(f);
+			std::size_t chunks = (count + chunk - 1) / chunk;
+			pending.m_remaining.store(chunks, std::memory_order_relaxed);
+
+			for (std::size_t i = 0; i < m_count; ++i)
+			{
+				std::lock_guard<std::mutex> lock(m_queues[i].m_mutex);
+
+				for (std::size_t c = i; c < chunks; c += m_count)
+				{
+					task t = { &pending, c * chunk, c * chunk + chunk < count ? c * chunk + chunk : count };
+					m_queues[i].m_tasks.push_back(t);
+				}
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_sleep_mutex);
+				m_pending.fetch_add(chunks, std::memory_order_release);
+			}
+
+			m_wake.notify_all();
+
+			while (pending.m_remaining.load(std::memory_order_acquire) != 0)
+			{
+				task t;
+
+				if (take(m_count, t)) {
+					execute(t);
+				}
+				else {
+					_yield();
+				}
+			}
+
+			if (pending.m_error) {
+				std::rethrow_exception(pending.m_error);
+			}
+		}
+
+	private:
+		static unsigned default_threads()
+		{
+			unsigned threads = std::thread::hardware_concurrency();
+			return threads > 1 ? threads - 1 : 0;
+		}
+
+		void work(std::size_t index)
+		{
+			for (;;)
+			{
+				task t;
+
+				if (take(index, t)) {
+					execute(t);
+					continue;
+				}
+
+				std::unique_lock<std::mutex> lock(m_sleep_mutex);
+				m_wake.wait(lock, [this] { return m_stop || m_pending.load(std::memory_order_acquire) != 0; });
+
+				if (m_stop && m_pending.load(std::memory_order_acquire) == 0) {
+					return;
+				}
+			}
+		}
+
+		// Own queue first (index == size() for a caller with none), then the others.
+		bool take(std::size_t index, task& t)
+		{
+			std::size_t count = m_count;
+
+			if (index < count)
+			{
+				std::lock_guard<std::mutex> lock(m_queues[index].m_mutex);
+
+				if (!m_queues[index].m_tasks.empty())
+				{
+					t = m_queues[index].m_tasks.back();
+					m_queues[index].m_tasks.pop_back();
+					m_pending.fetch_sub(1, std::memory_order_relaxed);
+					return true;
+				}
+			}
+
+			for (std::size_t i = 1; i <= count; ++i)
+			{
+				task_queue& victim = m_queues[(index + i) % count];
+				std::lock_guard<std::mutex> lock(victim.m_mutex);
+
+				if (!victim.m_tasks.empty())
+				{
+					t = victim.m_tasks.front();
+					victim.m_tasks.pop_front();
+					m_pending.fetch_sub(1, std::memory_order_relaxed);
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		static void execute(const task& t)
+		{
+			job* pjob = t.m_job;
+
+			try {
+				pjob->run(t.m_first, t.m_last);
+			}
+			catch (...)
+			{
+				if (!pjob->m_failed.exchange(true)) {
+					pjob->m_error = std::current_exception();
+				}
+			}
+
+			// The job may be gone as soon as this drops to zero.
+			pjob->m_remaining.fetch_sub(1, std::memory_order_acq_rel);
+		}
+	};
+#endif
+
+	// Epoch-based reclamation for memory that lock-free emitters may still be reading. An
+	// emitter announces the epoch it entered in its own thread's record and clears it on
+	// the way out; emission writes no shared state. A retired block is stamped with the
+	// epoch at retirement and freed once every emitter still inside entered after that.
+	// An emission that never returns holds back all reclamation.
+	class _epoch_domain
+	{
+	public:
+		struct record
+		{
+			alignas(64) std::atomic<std::uint64_t> m_epoch; // 0 outside any emission
+			std::atomic<bool> m_in_use;
+			std::size_t m_depth;
+			record* m_next;
+		};
+
+		// Never destroyed: threads may still emit during static destruction.
+		static _epoch_domain& instance()
+		{
+			static _epoch_domain* g_domain = new _epoch_domain;
+			return *g_domain;
+		}
+
+		// Reentrant; only the outermost emission on a thread publishes an epoch.
+		record* enter()
+		{
+			record* rec = local_record();
+
+			if (rec->m_depth++ == 0) {
+				rec->m_epoch.store(m_epoch.load(std::memory_order_acquire), std::memory_order_seq_cst);
+			}
+
+			return rec;
+		}
+
+		void leave(record* rec)
+		{
+			if (--rec->m_depth == 0) {
+				rec->m_epoch.store(0, std::memory_order_release);
+			}
+		}
+
+		// Call after p has been made unreachable for new emissions.
+		void retire(void* p, void (*deleter)(void*))
+		{
+			std::vector<retired> ready;
+
+			while (m_retire_lock.test_and_set(std::memory_order_acquire))
+			{}
+
+			retired item = { p, deleter, m_epoch.fetch_add(1, std::memory_order_seq_cst) };
+			m_retired.push_back(item);
+			std::uint64_t oldest = oldest_active();
+			std::size_t kept = 0;
+
+			for (std::size_t i = 0; i < m_retired.size(); ++i)
+			{
+				if (m_retired[i].m_epoch < oldest) {
+					ready.push_back(m_retired[i]);
+				}
+				else {
+					m_retired[kept++] = m_retired[i];
+				}
+			}
+
+			m_retired.resize(kept);
+			m_retire_lock.clear(std::memory_order_release);
+
+			// Outside the lock: a deleter may retire more.
+			for (std::size_t i = 0; i < ready.size(); ++i) {
+				ready[i].m_deleter(ready[i].m_pointer);
+			}
+		}
+
+	private:
+		struct retired
+		{
+			void* m_pointer;
+			void (*m_deleter)(void*);
+			std::uint64_t m_epoch;
+		};
+
+		struct local_holder
+		{
+			record* m_record;
+
+			~local_holder()
+			{
+				if (m_record) {
+					m_record->m_in_use.store(false, std::memory_order_release);
+				}
+			}
+		};
+
+		std::atomic<std::uint64_t> m_epoch;
+		std::atomic<record*> m_records;
+		std::atomic_flag m_retire_lock;
+		std::vector<retired> m_retired;
+
+		_epoch_domain()
+			: m_epoch(1), m_records(nullptr)
+		{
+			m_retire_lock.clear();
+		}
+
+		record* local_record()
+		{
+			static thread_local local_holder t_local = { nullptr };
+
+			if (!t_local.m_record) {
+				t_local.m_record = acquire_record();
+			}
+
+			return t_local.m_record;
+		}
+
+		// Records are reused after their thread exits and are never freed.
+		record* acquire_record()
+		{
+			for (record* rec = m_records.load(std::memory_order_acquire); rec; rec = rec->m_next)
+			{
+				bool expected = false;
+
+				if (!rec->m_in_use.load(std::memory_order_relaxed) &&
+					rec->m_in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+					return rec;
+				}
+			}
+
+			// Cache-line aligned by hand, as aligned new is C++17.
+			std::size_t space = sizeof(record) + alignof(record);
+			void* p = ::operator new(space);
+			std::align(alignof(record), sizeof(record), p, space);
+			record* rec = new (p) record;
+			rec->m_epoch.store(0, std::memory_order_relaxed);
+			rec->m_in_use.store(true, std::memory_order_relaxed);
+			rec->m_depth = 0;
+			rec->m_next = m_records.load(std::memory_order_relaxed);
+
+			while (!m_records.compare_exchange_weak(rec->m_next, rec, std::memory_order_release, std::memory_order_relaxed))
+			{}
+
+			return rec;
+		}
+
+		std::uint64_t oldest_active() const
+		{
+			std::uint64_t oldest = UINT64_MAX;
+
+			for (record* rec = m_records.load(std::memory_order_acquire); rec; rec = rec->m_next)
+			{
+				std::uint64_t epoch = rec->m_epoch.load(std::memory_order_seq_cst);
+
+				if (epoch != 0 && epoch < oldest) {
+					oldest = epoch;
+				}
+			}
+
+			return oldest;
+		}
+	};
+
+	struct _epoch_guard
+	{
+		_epoch_domain::record* m_record;
+
+		_epoch_guard()
+			: m_record(_epoch_domain::instance().enter())
+		{}
+
+		~_epoch_guard() {
+			_epoch_domain::instance().leave(m_record);
+		}
+
+		_epoch_guard(const _epoch_guard&) = delete;
+		_epoch_guard& operator=(const _epoch_guard&) = delete;
+	};
+
+	// Emission policy adaptor: basic_signals<copy_on_write<lock_policy>, args...> publishes an
+	// immutable snapshot of its connections whenever they change and emits from the latest
+	// snapshot without taking the lock. Connect/disconnect pay for the copy instead.
+	// Snapshots are reclaimed through _epoch_domain, so concurrent emitters on one signal
+	// share no written cache line but the call counts of the connections they call (see
+	// _call_frame), and scale with the number of cores.
+	// Receivers are still basic_has_slots<lock_policy>.
+	template<class lock_policy>
+	struct copy_on_write
+	{};
+
+	// A policy whose objects share locks with unrelated ones does not hold its lock while
+	// slots run, which could take any other lock: its emissions walk a copy made under the
+	// lock (detached_emit).
+	template<class mt_policy>
+	struct _policy_traits
+	{
+		typedef mt_policy lock_policy;
+		static const bool snapshot_emit = false;
+		static const bool shared_emit = false;
+		static const bool detached_emit = _ordered_locking<mt_policy>::value;
+	};
+
+	template<class inner_policy>
+	struct _policy_traits<copy_on_write<inner_policy> >
+	{
+		typedef inner_policy lock_policy;
+		static const bool snapshot_emit = true;
+		static const bool shared_emit = false;
+		static const bool detached_emit = false;
+	};
+
+#if !defined(SIGSLOT_PURE_ISO) && __cplusplus >= 201703L
+	template<>
+	struct _policy_traits<multi_threaded_shared>
+	{
+		typedef multi_threaded_shared lock_policy;
+		static const bool snapshot_emit = false;
+		static const bool shared_emit = true;
+		static const bool detached_emit = false;
+	};
+#endif
+
+	template<class mt_policy>
+	struct SharedGuard
+	{
+		mt_policy* m_mutex;
+
+		explicit SharedGuard(mt_policy* mtx)
+			: m_mutex(mtx)
+		{
+			m_mutex->lock_shared();
+		}
+
+		~SharedGuard() {
+			m_mutex->unlock_shared();
+		}
+
+		SharedGuard(const SharedGuard&) = delete;
+		SharedGuard& operator=(const SharedGuard&) = delete;
+	};
+
+	template<class mt_policy>
+	class basic_has_slots;
+
+	// Handle returned by connect(). It names one connection of one signal by slot index and
+	// generation. Disconnecting bumps the slot's generation, so a stale handle never matches
+	// a later connection that reuses the slot. The handle does not record its signal: it may
+	// be used with that signal and with copies made of it, and with no other.
+	class connection
+	{
+	public:
+		static const std::uint32_t npos = 0xffffffff;
+
+		connection()
+			: m_index(npos), m_generation(0)
+		{}
+
+		connection(std::uint32_t index, std::uint32_t generation)
+			: m_index(index), m_generation(generation)
+		{}
+
+		bool valid() const { return m_index != npos; }
+		std::uint32_t index() const { return m_index; }
+		std::uint32_t generation() const { return m_generation; }
+
+	private:
+		std::uint32_t m_index;
+		std::uint32_t m_generation;
+	};
+
+	// Orders a signal's slots, fixed when connecting: higher priorities are called first,
+	// and slots of equal priority in the order they were connected. The default is 0.
+	struct priority
+	{
+		int m_value;
+
+		explicit priority(int value = 0)
+			: m_value(value)
+		{}
+	};
+
+	template<class mt_policy>
+	struct _signal_base;
+
+	template<class mt_policy>
+	class _slot_target;
+
+	// One per connection, linked into the receiver's list so that a receiver can find and
+	// drop exactly its own connections. The signal finds the connection again through
+	// m_slot. m_prev/m_next belong to the receiver and are guarded by its lock. m_target
+	// is set when the connection owns state outside the signal (a queued slot, or a
+	// callable too large to store inline) and is released along with the link. Such a
+	// connection may have no receiver, in which case m_dest is null.
+	//
+	// Emitters that may race a disconnect skip the call once m_connected is cleared, and
+	// count the calls they make in m_calls (see _call_frame), which a disconnect that
+	// waits for calls already running waits on.
+	template<class mt_policy>
+	struct _connection_link
+	{
+		_connection_link* m_prev;
+		_connection_link* m_next;
+		_signal_base<mt_policy>* m_signal;
+		basic_has_slots<mt_policy>* m_dest;
+		_slot_target<mt_policy>* m_target;
+		std::uint32_t m_slot;
+		std::atomic<bool> m_connected;
+		std::atomic<std::uint32_t> m_calls;
+
+		// Ordered after the emitter's count, so either the emitter sees the flag cleared
+		// or a wait that follows the clear sees the call.
+		bool connected() const {
+			return m_connected.load(std::memory_order_seq_cst);
+		}
+	};
+
+	// A call counted for the waits of disconnect_and_wait(), on a link or on whatever else
+	// stands for the calls. Emitters pay an atomic increment and decrement on memory
+	// nobody else writes unless they call the same connection at once. Frames are also
+	// listed on their own thread, which never waits for its own calls: a slot may drop
+	// its own connection and wait for other threads still running it.
+	class _call_frame
+	{
+		std::atomic<std::uint32_t>* m_calls;
+		_call_frame* m_prev;
+
+	public:
+		// A null calls counts nothing.
+		explicit _call_frame(std::atomic<std::uint32_t>* calls)
+			: m_calls(calls), m_prev(nullptr)
+		{
+			if (calls)
+			{
+				calls->fetch_add(1, std::memory_order_seq_cst);
+				m_prev = top();
+				top() = this;
+			}
+		}
+
+		~_call_frame()
+		{
+			if (m_calls)
+			{
+				top() = m_prev;
+				m_calls->fetch_sub(1, std::memory_order_release);
+			}
+		}
+
+		_call_frame(const _call_frame&) = delete;
+		_call_frame& operator=(const _call_frame&) = delete;
+
+		// Returns once calls counts no frame of another thread. Expects whatever holds
+		// calls to stay readable meanwhile.
+		static void wait(const std::atomic<std::uint32_t>& calls)
+		{
+			std::uint32_t own = 0;
+
+			for (const _call_frame* frame = top(); frame; frame = frame->m_prev)
+			{
+				if (frame->m_calls == &calls) {
+					++own;
+				}
+			}
+
+			while (calls.load(std::memory_order_seq_cst) > own) {
+				_yield();
+			}
+		}
+
+	private:
+		static _call_frame*& top()
+		{
+			static thread_local _call_frame* t_top = nullptr;
+			return t_top;
+		}
+	};
+
+	// Tags a walk over a detached emission's copy of the connections. Callables stored
+	// inline have no link and nothing to check: the copy holds everything they need, and
+	// the emission is counted as a whole.
+	struct _detached_walk
+	{};
+
+	class _unknown_class;
+
+	// Pointers to members of an incomplete class have the largest representation the
+	// compiler uses, so any member function pointer fits in this much storage.
+	typedef void (_unknown_class::*_generic_memfun)();
+
+	template<class... types>
+	struct _type_list
+	{};
+
+	template<bool... values>
+	struct _all_of;
+
+	template<>
+	struct _all_of<> : std::true_type
+	{};
+
+	template<bool value, bool... rest>
+	struct _all_of<value, rest...> : std::integral_constant<bool, value && _all_of<rest...>::value>
+	{};
+
+	// How a signal argument travels to the slots: by const reference while further slots
+	// still need it, and as an rvalue to the last slot when the emitter gave up
+	// ownership. Reference arguments pass through unchanged either way.
+	template<class T>
+	struct _arg
+	{
+		typedef const T& type;
+		typedef T&& rvalue;
+	};
+
+	template<class T>
+	struct _arg<T&>
+	{
+		typedef T& type;
+		typedef T& rvalue;
+	};
+
+	// Adapts an argument held by const reference to the slot's parameter type. Only a slot
+	// taking an rvalue reference needs its own copy.
+	template<class slot_arg>
+	struct _slot_param
+	{
+		template<class T>
+		static T& pass(T& arg) {
+			return arg;
+		}
+	};
+
+	template<class slot_arg>
+	struct _slot_param<slot_arg&&>
+	{
+		template<class T>
+		static typename std::decay<slot_arg>::type pass(T& arg) {
+			return arg;
+		}
+	};
+
+	template<std::size_t... indices>
+	struct _index_list
+	{};
+
+	template<std::size_t count, std::size_t... indices>
+	struct _make_index_list : _make_index_list<count - 1, count - 1, indices...>
+	{};
+
+	template<std::size_t... indices>
+	struct _make_index_list<0, indices...>
+	{
+		typedef _index_list<indices...> type;
+	};
+
+	template<class memfun_type>
+	struct _memfun_args;
+
+	template<class dest_type, class... slot_args>
+	struct _memfun_args<void (dest_type::*)(slot_args...)>
+	{
+		typedef _type_list<slot_args...> type;
+	};
+
+	// A connection is a plain value: the receiver object, thunks generated for the
+	// receiver's type that perform the call, and the member function they call.
+	// Emission is a single indirect call through m_invoke; nothing is heap allocated.
+	// m_invoke_move is used instead for the last slot of an emission given rvalues.
+	template<class mt_policy, typename... args_type>
+	struct _connection
+	{
+		typedef void (*invoke_type)(const _connection&, typename _arg<args_type>::type...);
+		typedef void (*invoke_move_type)(const _connection&, typename _arg<args_type>::rvalue...);
+
+		invoke_type m_invoke;
+		void* m_object;
+		union {
+			_generic_memfun m_align;
+			unsigned char m_memfun[sizeof(_generic_memfun)];
+		};
+		invoke_move_type m_invoke_move;
+		_connection_link<mt_policy>* m_link;
+		std::uint32_t m_slot;
+		int m_priority;
+
+		basic_has_slots<mt_policy>* getdest() const {
+			return m_link ? m_link->m_dest : nullptr;
+		}
+
+		// Same slot, called on another receiver of the same type. The copy is not linked yet.
+		_connection duplicate(basic_has_slots<mt_policy>* pnewdest) const
+		{
+			_connection conn = *this;
+			conn.repoint(getdest(), pnewdest);
+			conn.m_link = nullptr;
+			return conn;
+		}
+
+		// From the receiver pdest to pnewdest, of the same type. The receiver object sits
+		// at the same offset from its has_slots base in both, so no cast is needed (the
+		// new receiver may still be under construction).
+		void repoint(basic_has_slots<mt_policy>* pdest, basic_has_slots<mt_policy>* pnewdest) {
+			m_object = reinterpret_cast<char*>(pnewdest) - (reinterpret_cast<char*>(pdest) - static_cast<char*>(m_object));
+		}
+	};
+
+	template<class dest_type, class mt_policy, class signal_args, class slot_args>
+	struct _connection_thunks;
+
+	template<class dest_type, class mt_policy, class... args_type, class... slot_args>
+	struct _connection_thunks<dest_type, mt_policy, _type_list<args_type...>, _type_list<slot_args...> >
+	{
+		typedef _connection<mt_policy, args_type...> connection_type;
+		typedef void (dest_type::* memfun_type)(slot_args...);
+
+		static_assert(sizeof...(args_type) == sizeof...(slot_args), "slot must take one parameter per signal argument");
+
+		static void invoke(const connection_type& conn, typename _arg<args_type>::type... args)
+		{
+			memfun_type pmemfun;
+			std::memcpy(&pmemfun, conn.m_memfun, sizeof(pmemfun));
+			(static_cast<dest_type*>(conn.m_object)->*pmemfun)(_slot_param<slot_args>::pass(args)...);
+		}
+
+		static void invoke_move(const connection_type& conn, typename _arg<args_type>::rvalue... args)
+		{
+			memfun_type pmemfun;
+			std::memcpy(&pmemfun, conn.m_memfun, sizeof(pmemfun));
+			(static_cast<dest_type*>(conn.m_object)->*pmemfun)(std::forward<typename _arg<args_type>::rvalue>(args)...);
+		}
+
+		template<memfun_type pmemfun>
+		static void invoke_static(const connection_type& conn, typename _arg<args_type>::type... args) {
+			(static_cast<dest_type*>(conn.m_object)->*pmemfun)(_slot_param<slot_args>::pass(args)...);
+		}
+
+		template<memfun_type pmemfun>
+		static void invoke_static_move(const connection_type& conn, typename _arg<args_type>::rvalue... args) {
+			(static_cast<dest_type*>(conn.m_object)->*pmemfun)(std::forward<typename _arg<args_type>::rvalue>(args)...);
+		}
+
+		static connection_type make(dest_type* pobject, memfun_type pmemfun)
+		{
+			static_assert(sizeof(memfun_type) <= sizeof(_generic_memfun), "member function pointer too large");
+
+			connection_type conn;
+			conn.m_invoke = &invoke;
+			conn.m_object = pobject;
+			std::memset(conn.m_memfun, 0, sizeof(conn.m_memfun));
+			std::memcpy(conn.m_memfun, &pmemfun, sizeof(pmemfun));
+			conn.m_invoke_move = &invoke_move;
+			conn.m_link = nullptr;
+			conn.m_slot = 0;
+			conn.m_priority = 0;
+			return conn;
+		}
+
+		template<memfun_type pmemfun>
+		static connection_type make_static(dest_type* pobject)
+		{
+			connection_type conn = make(pobject, pmemfun);
+			conn.m_invoke = &invoke_static<pmemfun>;
+			conn.m_invoke_move = &invoke_static_move<pmemfun>;
+			return conn;
+		}
+	};
+
+	// State a connection owns outside the signal. A connection with a target stores it in
+	// m_object as a _slot_target*, and its thunks cast back from there.
+	template<class mt_policy>
+	class _slot_target
+	{
+	public:
+		virtual ~_slot_target() {}
+
+		// A new target for the same slot on another receiver of the same type, for a signal
+		// that allocates its targets from resource.
+		virtual _slot_target* duplicate(basic_has_slots<mt_policy>* pnewdest, memory_resource* resource) const = 0;
+
+		// The receiver was moved to pnewdest; called with the signal locked.
+		virtual void relocate(basic_has_slots<mt_policy>*)
+		{}
+
+		// Called once, as soon as the connection goes away.
+		virtual void disconnect()
+		{}
+
+		// Called once, when no emission can still be calling through the target.
+		virtual void release() {
+			delete this;
+		}
+	};
+
+	// The receiver end of a queued connection, shared by the connection and the calls it
+	// has queued. Disconnecting marks it disconnected so that pending calls are dropped;
+	// the last reference frees it. The flag is read by the dispatching thread, so a queued
+	// receiver must be disconnected or destroyed on that thread, or while it is not
+	// dispatching.
+	template<class mt_policy>
+	class _queued_target : public _slot_target<mt_policy>
+	{
+		std::atomic<std::size_t> m_refs;
+		std::atomic<bool> m_connected;
+
+	public:
+		dispatcher* m_dispatcher;
+
+		explicit _queued_target(dispatcher* pdispatcher)
+			: m_refs(1), m_connected(true), m_dispatcher(pdispatcher)
+		{}
+
+		bool connected() const {
+			return m_connected.load(std::memory_order_acquire);
+		}
+
+		void acquire() {
+			m_refs.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		// The connection and each pending call hold one reference.
+		virtual void release()
+		{
+			if (m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				delete this;
+			}
+		}
+
+		virtual void disconnect() {
+			m_connected.store(false, std::memory_order_release);
+		}
+	};
+
+	// What queued and conflated connections share: the direct connection m_slot they call
+	// from dispatch(), the connection that hands each emission to derived::post() instead,
+	// and following the receiver as it is copied or moved.
+	template<class derived, class mt_policy, class... args_type>
+	class _queued_slot_base : public _queued_target<mt_policy>
+	{
+		typedef _queued_target<mt_policy> base_type;
+		typedef _slot_target<mt_policy> target_type;
+
+	public:
+		typedef _connection<mt_policy, args_type...> connection_type;
+
+		connection_type m_slot;
+		basic_has_slots<mt_policy>* m_dest;
+
+		_queued_slot_base(dispatcher* pdispatcher, const connection_type& slot, basic_has_slots<mt_policy>* pdest)
+			: base_type(pdispatcher), m_slot(slot), m_dest(pdest)
+		{}
+
+		// Shared with the dispatching thread, so from the heap.
+		target_type* duplicate(basic_has_slots<mt_policy>* pnewdest, memory_resource*) const
+		{
+			connection_type slot = m_slot;
+			slot.repoint(m_dest, pnewdest);
+			return static_cast<const derived*>(this)->clone(slot, pnewdest);
+		}
+
+		// Calls already queued go to the new receiver too.
+		void relocate(basic_has_slots<mt_policy>* pnewdest)
+		{
+			m_slot.repoint(m_dest, pnewdest);
+			m_dest = pnewdest;
+		}
+
+		// The connection that posts to this target.
+		connection_type make_connection()
+		{
+			connection_type conn = m_slot;
+			conn.m_invoke = &invoke;
+			conn.m_object = static_cast<target_type*>(this);
+			conn.m_invoke_move = &invoke_move;
+			return conn;
+		}
+
+		static void invoke(const connection_type& conn, typename _arg<args_type>::type... args) {
+			get(conn)->post(args...);
+		}
+
+		static void invoke_move(const connection_type& conn, typename _arg<args_type>::rvalue... args) {
+			get(conn)->post(std::forward<typename _arg<args_type>::rvalue>(args)...);
+		}
+
+	private:
+		static derived* get(const connection_type& conn) {
+			return static_cast<derived*>(static_cast<target_type*>(conn.m_object));
+		}
+	};
+
+	// Queued connections are ordinary connections whose thunks copy the arguments into a
+	// _queued_invocation and post it; the slot itself is the direct connection m_slot,
+	// called later from dispatch(). Reference arguments refer to the queued copy. The
+	// invocations' storage goes back to the target once they have run, for the next
+	// emissions to reuse, so only a backlog longer than any before it allocates.
+	template<class mt_policy, class... args_type>
+	class _queued_slot : public _queued_slot_base<_queued_slot<mt_policy, args_type...>, mt_policy, args_type...>
+	{
+		typedef _queued_slot_base<_queued_slot, mt_policy, args_type...> base_type;
+		typedef _slot_target<mt_policy> target_type;
+		typedef _connection<mt_policy, args_type...> connection_type;
+
+		friend base_type;
+
+		class _queued_invocation : public _queued_call
+		{
+			_queued_slot* m_target;
+			std::tuple<typename std::decay<args_type>::type...> m_args;
+
+		public:
+			template<class... call_args>
+			explicit _queued_invocation(_queued_slot* ptarget, call_args&&... args)
+				: m_target(ptarget), m_args(std::forward<call_args>(args)...)
+			{
+				m_target->acquire();
+			}
+
+			void run()
+			{
+				if (m_target->connected()) {
+					call(typename _make_index_list<sizeof...(args_type)>::type());
+				}
+			}
+
+			// The target outlives its storage, which it holds a reference for.
+			void destroy()
+			{
+				_queued_slot* ptarget = m_target;
+				this->~_queued_invocation();
+				ptarget->give_back(this);
+				ptarget->release();
+			}
+
+		private:
+			template<std::size_t... indices>
+			void call(_index_list<indices...>)
+			{
+				const connection_type& conn = m_target->m_slot;
+				conn.m_invoke_move(conn, static_cast<typename _arg<args_type>::rvalue>(std::get<indices>(m_args))...);
+			}
+		};
+
+	public:
+		_queued_slot(dispatcher* pdispatcher, const connection_type& slot, basic_has_slots<mt_policy>* pdest)
+			: base_type(pdispatcher, slot, pdest), m_free(nullptr)
+		{}
+
+		~_queued_slot()
+		{
+			while (free_block* block = m_free)
+			{
+				m_free = block->m_next;
+				::operator delete(block);
+			}
+		}
+
+	private:
+		struct free_block
+		{
+			free_block* m_next;
+		};
+
+		_spin_flag m_free_lock; // emitters take storage, the dispatching thread gives it back
+		free_block* m_free;
+
+		target_type* clone(const connection_type& slot, basic_has_slots<mt_policy>* pnewdest) const {
+			return new _queued_slot(base_type::m_dispatcher, slot, pnewdest);
+		}
+
+		template<class... call_args>
+		void post(call_args&&... args)
+		{
+			void* p = take();
+			_queued_invocation* call;
+
+			try {
+				call = new (p) _queued_invocation(this, std::forward<call_args>(args)...);
+			}
+			catch (...)
+			{
+				give_back(p);
+				throw;
+			}
+
+			base_type::m_dispatcher->post(call);
+		}
+
+		void* take()
+		{
+			{
+				StaticGuard<_spin_flag> guard(&m_free_lock);
+
+				if (free_block* block = m_free)
+				{
+					m_free = block->m_next;
+					return block;
+				}
+			}
+
+			static_assert(sizeof(_queued_invocation) >= sizeof(free_block), "storage must hold a free_block");
+			return ::operator new(sizeof(_queued_invocation));
+		}
+
+		void give_back(void* p)
+		{
+			free_block* block = static_cast<free_block*>(p);
+			StaticGuard<_spin_flag> guard(&m_free_lock);
+			block->m_next = m_free;
+			m_free = block;
+		}
+	};
+
+	// Pending values of a conflated connection: only the latest.
+	template<class tuple_type>
+	class _latest_values
+	{
+		std::unique_ptr<tuple_type> m_value;
+
+	public:
+		_latest_values fresh() const {
+			return _latest_values();
+		}
+
+		// Assigning into the held value lets it reuse its storage.
+		template<class source>
+		void put(source&& values)
+		{
+			if (m_value) {
+				*m_value = std::forward<source>(values);
+			}
+			else {
+				m_value.reset(new tuple_type(std::forward<source>(values)));
+			}
+		}
+
+		void swap(_latest_values& other) {
+			m_value.swap(other.m_value);
+		}
+
+		template<class target_type>
+		void deliver(target_type* ptarget)
+		{
+			if (m_value) {
+				ptarget->call(*m_value);
+			}
+		}
+	};
+
+	// Pending values of a conflated connection: the latest per key, in the order the
+	// keys first appeared.
+	template<class tuple_type, class key_function>
+	class _keyed_values
+	{
+		template<class... values_type>
+		static typename std::decay<decltype(std::declval<const key_function&>()(std::declval<const values_type&>()...))>::type
+			key_of(std::tuple<values_type...>*);
+
+		typedef decltype(key_of(static_cast<tuple_type*>(nullptr))) key_type;
+
+		key_function m_key;
+		std::vector<tuple_type> m_values;
+		std::unordered_map<key_type, std::size_t> m_index;
+
+	public:
+		explicit _keyed_values(const key_function& key)
+			: m_key(key)
+		{}
+
+		_keyed_values fresh() const {
+			return _keyed_values(m_key);
+		}
+
+		template<class source>
+		void put(source&& values)
+		{
+			key_type key = apply_key(values, typename _make_index_list<std::tuple_size<tuple_type>::value>::type());
+			typename std::unordered_map<key_type, std::size_t>::iterator it = m_index.find(key);
+
+			if (it != m_index.end()) {
+				m_values[it->second] = std::forward<source>(values);
+			}
+			else
+			{
+				m_values.push_back(tuple_type(std::forward<source>(values)));
+				m_index.insert(std::make_pair(std::move(key), m_values.size() - 1));
+			}
+		}
+
+		void swap(_keyed_values& other)
+		{
+			m_values.swap(other.m_values);
+			m_index.swap(other.m_index);
+		}
+
+		template<class target_type>
+		void deliver(target_type* ptarget)
+		{
+			for (std::size_t i = 0; i < m_values.size(); ++i) {
+				ptarget->call(m_values[i]);
+			}
+		}
+
+	private:
+		template<class source, std::size_t... indices>
+		key_type apply_key(const source& values, _index_list<indices...>) const {
+			return m_key(std::get<indices>(values)...);
+		}
+	};
+
+	// A queued connection that holds at most one pending call. Emissions made before the
+	// dispatcher gets to it overwrite the pending values (or, with a key, the values
+	// pending under the same key), so a slow receiver only ever sees the latest state and
+	// superseded values are never delivered. The values have a lock of their own, as the
+	// dispatching thread takes them whatever the policy.
+	template<class mt_policy, class values_type, class... args_type>
+	class _conflated_slot : public _queued_slot_base<_conflated_slot<mt_policy, values_type, args_type...>, mt_policy, args_type...>
+	{
+		typedef _queued_slot_base<_conflated_slot, mt_policy, args_type...> base_type;
+		typedef _slot_target<mt_policy> target_type;
+		typedef _connection<mt_policy, args_type...> connection_type;
+		typedef std::tuple<typename std::decay<args_type>::type...> tuple_type;
+
+		friend base_type;
+
+		class _conflated_delivery : public _queued_call
+		{
+			_conflated_slot* m_target;
+
+		public:
+			explicit _conflated_delivery(_conflated_slot* ptarget)
+				: m_target(ptarget)
+			{
+				m_target->acquire();
+			}
+
+			~_conflated_delivery() {
+				m_target->release();
+			}
+
+			void run() {
+				m_target->deliver();
+			}
+		};
+
+		_spin_flag m_lock; // guards m_pending and m_posted
+		values_type m_pending;
+		bool m_posted;
+
+	public:
+		_conflated_slot(dispatcher* pdispatcher, const connection_type& slot, basic_has_slots<mt_policy>* pdest, values_type&& values)
+			: base_type(pdispatcher, slot, pdest), m_pending(std::move(values)), m_posted(false)
+		{}
+
+		void call(tuple_type& values)
+		{
+			if (base_type::connected()) {
+				call(values, typename _make_index_list<sizeof...(args_type)>::type());
+			}
+		}
+
+	private:
+		target_type* clone(const connection_type& slot, basic_has_slots<mt_policy>* pnewdest) const {
+			return new _conflated_slot(base_type::m_dispatcher, slot, pnewdest, m_pending.fresh());
+		}
+
+		template<class... call_args>
+		void post(call_args&&... args)
+		{
+			bool first;
+
+			{
+				StaticGuard<_spin_flag> guard(&m_lock);
+				m_pending.put(std::forward_as_tuple(std::forward<call_args>(args)...));
+				first = !m_posted;
+				m_posted = true;
+			}
+
+			if (first) {
+				base_type::m_dispatcher->post(new _conflated_delivery(this));
+			}
+		}
+
+		// Takes the pending values out under the lock, so emitters can refill them while
+		// the slot runs.
+		void deliver()
+		{
+			values_type ready(m_pending.fresh());
+
+			{
+				StaticGuard<_spin_flag> guard(&m_lock);
+				ready.swap(m_pending);
+				m_posted = false;
+			}
+
+			ready.deliver(this);
+		}
+
+		template<std::size_t... indices>
+		void call(tuple_type& values, _index_list<indices...>)
+		{
+			base_type::m_slot.m_invoke_move(base_type::m_slot, static_cast<typename _arg<args_type>::rvalue>(std::get<indices>(values))...);
+		}
+	};
+
+	// A callable connected without a receiver. One that is trivially copyable, fits in
+	// the member function storage and can be called const lives in the connection itself,
+	// so lambdas capturing a pointer or two and plain function pointers cost no
+	// allocation; anything else, a mutable lambda included, is kept in a _callable_target
+	// owned by the connection.
+	template<class functor>
+	struct _fits_inline : std::integral_constant<bool,
+		std::is_trivially_copyable<functor>::value &&
+		sizeof(functor) <= sizeof(_generic_memfun) &&
+		alignof(functor) <= alignof(_generic_memfun)>
+	{};
+
+	template<class functor, class... args_type>
+	class _const_callable
+	{
+		template<class f, class = decltype(std::declval<const f&>()(std::declval<typename _arg<args_type>::type>()...))>
+		static std::true_type test(int);
+
+		template<class f>
+		static std::false_type test(...);
+
+	public:
+		static const bool value = decltype(test<functor>(0))::value;
+	};
+
+	// Allocated from its signal's resource, and freed back to it when released.
+	template<class mt_policy, class functor>
+	class _callable_target : public _slot_target<mt_policy>
+	{
+		static_assert(std::is_copy_constructible<functor>::value, "connected callables must be copyable");
+
+		memory_resource* m_resource;
+
+		template<class init_type>
+		_callable_target(init_type&& f, memory_resource* resource)
+			: m_resource(resource), m_functor(std::forward<init_type>(f))
+		{}
+
+	public:
+		functor m_functor;
+
+		template<class init_type>
+		static _callable_target* create(init_type&& f, memory_resource* resource)
+		{
+			void* p = resource->allocate(sizeof(_callable_target), alignof(_callable_target));
+
+			try {
+				return new (p) _callable_target(std::forward<init_type>(f), resource);
+			}
+			catch (...)
+			{
+				resource->deallocate(p, sizeof(_callable_target), alignof(_callable_target));
+				throw;
+			}
+		}
+
+		_slot_target<mt_policy>* duplicate(basic_has_slots<mt_policy>*, memory_resource* resource) const {
+			return create(m_functor, resource);
+		}
+
+		void release()
+		{
+			memory_resource* resource = m_resource;
+			this->~_callable_target();
+			resource->deallocate(this, sizeof(_callable_target), alignof(_callable_target));
+		}
+	};
+
+	template<class functor, class mt_policy, class... args_type>
+	struct _callable_thunks
+	{
+		typedef _connection<mt_policy, args_type...> connection_type;
+		typedef _callable_target<mt_policy, functor> target_type;
+		static const bool inline_storage = _fits_inline<functor>::value && _const_callable<functor, args_type...>::value;
+
+		// An inline callable is called through a copy. Its connection moves if the slot
+		// connects to its own signal and the array grows, and a copy_on_write snapshot is
+		// shared by every emitter. Having no state to change, the copy behaves as the
+		// original would.
+		static functor get(const connection_type& conn, std::true_type) {
+			return *reinterpret_cast<const functor*>(conn.m_memfun);
+		}
+
+		static functor& get(const connection_type& conn, std::false_type) {
+			return static_cast<target_type*>(static_cast<_slot_target<mt_policy>*>(conn.m_object))->m_functor;
+		}
+
+		static void invoke(const connection_type& conn, typename _arg<args_type>::type... args) {
+			get(conn, std::integral_constant<bool, inline_storage>())(args...);
+		}
+
+		static void invoke_move(const connection_type& conn, typename _arg<args_type>::rvalue... args) {
+			get(conn, std::integral_constant<bool, inline_storage>())(std::forward<typename _arg<args_type>::rvalue>(args)...);
+		}
+
+		// Returns the target the connection owns, from resource, or null when the callable
+		// is stored inline.
+		template<class init_type>
+		static _slot_target<mt_policy>* make(connection_type& conn, init_type&& f, memory_resource* resource)
+		{
+			conn.m_invoke = &invoke;
+			conn.m_object = nullptr;
+			std::memset(conn.m_memfun, 0, sizeof(conn.m_memfun));
+			conn.m_invoke_move = &invoke_move;
+			conn.m_link = nullptr;
+			conn.m_slot = 0;
+			conn.m_priority = 0;
+			return store(conn, std::forward<init_type>(f), resource, std::integral_constant<bool, inline_storage>());
+		}
+
+	private:
+		template<class init_type>
+		static _slot_target<mt_policy>* store(connection_type& conn, init_type&& f, memory_resource*, std::true_type)
+		{
+			new (conn.m_memfun) functor(std::forward<init_type>(f));
+			return nullptr;
+		}
+
+		template<class init_type>
+		static _slot_target<mt_policy>* store(connection_type& conn, init_type&& f, memory_resource* resource, std::false_type)
+		{
+			_slot_target<mt_policy>* target = target_type::create(std::forward<init_type>(f), resource);
+			conn.m_object = target;
+			return target;
+		}
+	};
+
+	template<class mt_policy>
+	struct _signal_base : public mt_policy
+	{
+		_signal_base()
+			: m_waiters(0)
+		{}
+
+		_signal_base(const _signal_base& s)
+			: mt_policy(s), m_waiters(0)
+		{}
+
+		virtual ~_signal_base() {
+			wait_for_waiters();
+		}
+
+		// Called by the receiver, with the receiver locked, for one of its own links. The
+		// receiver has already unlinked it; the signal frees it. With wait, or under a
+		// policy whose emissions call slots with no lock held (detached_emit), returns whether
+		// calls through the connection may still be running. If so, the link stays readable
+		// and the signal in place until the receiver, having waited out plink->m_calls with
+		// its lock let go of, calls end_wait().
+		virtual bool slot_disconnect(_connection_link<mt_policy>* plink, bool wait) = 0;
+		virtual void slot_duplicate(const _connection_link<mt_policy>* plink, basic_has_slots<mt_policy>* pnewslot) = 0;
+
+		// Called by a receiver being moved, with both it and pnewslot locked, for each link
+		// it hands over. The signal re-points the connection at pnewslot in place.
+		virtual void slot_relocate(_connection_link<mt_policy>* plink, basic_has_slots<mt_policy>* pnewslot) = 0;
+
+		// Without the lock, as the signal may be going away.
+		void end_wait() {
+			m_waiters.fetch_sub(1, std::memory_order_release);
+		}
+
+	protected:
+		std::atomic<int> m_waiters; // disconnects waiting on calls through removed links
+
+		void wait_for_waiters() const
+		{
+			while (m_waiters.load(std::memory_order_acquire) != 0) {
+				_yield();
+			}
+		}
+	};
+
+	template<class mt_policy = SIGSLOT_DEFAULT_MT_POLICY>
+	class basic_has_slots : public mt_policy
+	{
+		typedef _connection_link<mt_policy> link_type;
+
+		link_type* m_links;
+
+	public:
+		basic_has_slots()
+			: m_links(nullptr)
+		{}
+
+		// hs is read under its lock, as its signals may be rewiring it.
+		basic_has_slots(const basic_has_slots& hs)
+			: mt_policy(hs), m_links(nullptr)
+		{
+			for (;;)
+			{
+				{
+					_ordered_guard<mt_policy> guard(const_cast<basic_has_slots*>(&hs), this, [&hs](_lock_set<mt_policy>& objects) { hs.add_signals(objects); });
+
+					if (hs.try_lock_signals())
+					{
+						// A compact signal re-points hs's link at the signal it grows into, so
+						// what was locked is let go of as it was before the duplicate.
+						for (const link_type* link = hs.m_links; link; link = link->m_next)
+						{
+							_signal_base<mt_policy>* psignal = link->m_signal;
+							psignal->slot_duplicate(link, this);
+							psignal->unlock();
+						}
+
+						return;
+					}
+				}
+
+				_yield();
+			}
+		}
+
+		// Takes over hs's connections without reallocating any: each signal re-points its
+		// connection at this receiver in place, so receivers can live in a std::vector.
+		// hs is left with none. A copy_on_write emission already under way may still call
+		// hs, as may a queued call being dispatched on another thread. Nothing is allocated
+		// but a copy_on_write signal's new snapshot, running out of memory for which ends
+		// the program.
+		basic_has_slots(basic_has_slots&& hs) noexcept
+			: mt_policy(hs), m_links(nullptr)
+		{
+			take_links(hs);
+		}
+
+		// Copy assignment leaves both receivers' connections as they are.
+		basic_has_slots& operator=(const basic_has_slots&) {
+			return *this;
+		}
+
+		// Move assignment drops this receiver's connections and takes over hs's. Dropping
+		// them may allocate, as a signal defers freeing what its emissions still use.
+		basic_has_slots& operator=(basic_has_slots&& hs)
+		{
+			if (this != &hs)
+			{
+				disconnect_all();
+				take_links(hs);
+			}
+
+			return *this;
+		}
+
+		void signal_connect(link_type* link)
+		{
+			StaticGuard<mt_policy> guard(this);
+			link->m_prev = nullptr;
+			link->m_next = m_links;
+
+			if (m_links) {
+				m_links->m_prev = link;
+			}
+
+			m_links = link;
+		}
+
+		void signal_disconnect(link_type* link)
+		{
+			StaticGuard<mt_policy> guard(this);
+
+			if (link->m_prev) {
+				link->m_prev->m_next = link->m_next;
+			}
+			else {
+				m_links = link->m_next;
+			}
+
+			if (link->m_next) {
+				link->m_next->m_prev = link->m_prev;
+			}
+		}
+
+		virtual ~basic_has_slots() {
+			disconnect_all();
+		}
+
+		// Visits only this receiver's own connections. Under a striped policy, whose
+		// emissions let go of the stripe before calling slots, it also waits for their calls
+		// running on other threads, so the receiver may go away after it.
+		void disconnect_all() {
+			disconnect_links(false);
+		}
+
+		// Also returns only once no slot of this receiver is still running on another
+		// thread. A receiver that copy_on_write signals may be emitting into calls this
+		// first thing in its destructor, while its members are still intact. It waits for
+		// calls of this receiver's own connections only, one at a time with no lock held,
+		// and not for those of the calling thread, so a slot may call it. It must not be
+		// called while holding a lock that such a call may take.
+		void disconnect_all_and_wait()
+		{
+			// Keeps removed copy_on_write links readable for the waits.
+			_epoch_guard epoch;
+			disconnect_links(true);
+		}
+
+	private:
+		// Under a striped policy the signals' stripes are taken along with the receivers',
+		// in stripe order, as signals lock their receivers the other way round.
+		void add_signals(_lock_set<mt_policy>& objects) const
+		{
+			for (const link_type* link = m_links; link; link = link->m_next) {
+				objects.add(link->m_signal);
+			}
+		}
+
+		// With this receiver locked, a signal's lock may only be tried for, as the signal
+		// may be holding it while it waits for this one (see _ordered_guard). Until the
+		// receiver lets go, a signal still linked to it cannot finish going away.
+		// try_lock_signals() takes all of them or, failing that, none.
+		bool try_lock_signals() const
+		{
+			for (const link_type* link = m_links; link; link = link->m_next)
+			{
+				if (!link->m_signal->try_lock())
+				{
+					unlock_signals(link);
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		// Up to, not including, last.
+		void unlock_signals(const link_type* last) const
+		{
+			for (const link_type* link = m_links; link != last; link = link->m_next) {
+				link->m_signal->unlock();
+			}
+		}
+
+		void unlink_first()
+		{
+			m_links = m_links->m_next;
+
+			if (m_links) {
+				m_links->m_prev = nullptr;
+			}
+		}
+
+		// Link by link, so that connections already handed over stay handed over when a
+		// signal's lock is not to be had and everything is let go for another round.
+		void take_links(basic_has_slots& hs)
+		{
+			for (;;)
+			{
+				{
+					_ordered_guard<mt_policy> guard(this, &hs, [&hs](_lock_set<mt_policy>& objects) { hs.add_signals(objects); });
+
+					while (link_type* link = hs.m_links)
+					{
+						_signal_base<mt_policy>* psignal = link->m_signal;
+
+						if (!psignal->try_lock()) {
+							break;
+						}
+
+						hs.unlink_first();
+						link->m_prev = nullptr;
+						link->m_next = m_links;
+
+						if (m_links) {
+							m_links->m_prev = link;
+						}
+
+						m_links = link;
+						psignal->slot_relocate(link, this);
+						psignal->unlock();
+					}
+
+					if (!hs.m_links) {
+						return;
+					}
+				}
+
+				_yield();
+			}
+		}
+
+		// A link whose calls are to be waited for is waited for before the next one is
+		// taken, with everything let go of.
+		void disconnect_links(bool wait)
+		{
+			for (bool done = false; !done; )
+			{
+				_signal_base<mt_policy>* pwaiting = nullptr;
+				const link_type* pwaited = nullptr;
+
+				{
+					_ordered_guard<mt_policy> guard(this, nullptr, [this](_lock_set<mt_policy>& objects) { add_signals(objects); });
+
+					while (link_type* link = m_links)
+					{
+						_signal_base<mt_policy>* psignal = link->m_signal;
+
+						if (!psignal->try_lock()) {
+							break;
+						}
+
+						unlink_first();
+						bool running = psignal->slot_disconnect(link, wait);
+						psignal->unlock();
+
+						if (running)
+						{
+							pwaiting = psignal;
+							pwaited = link;
+							break;
+						}
+					}
+
+					done = !m_links;
+				}
+
+				if (pwaiting)
+				{
+					_call_frame::wait(pwaited->m_calls);
+					pwaiting->end_wait();
+				}
+				else if (!done) {
+					_yield();
+				}
+			}
+		}
+	};
+
+	typedef basic_has_slots<> has_slots;
+
+	// Contiguous storage for the connection list: the first N entries live inside the
+	// signal, larger fan-outs spill to one block from the memory resource. Elements must
+	// be trivially copyable, as they are relocated with memcpy.
+	template<class T, std::size_t N>
+	class _small_vector
+	{
+		T* m_data;
+		std::size_t m_size;
+		std::size_t m_capacity;
+		memory_resource* m_resource;
+		T m_inline[N];
+
+		static_assert(N > 0, "inline capacity must be at least one element");
+		static_assert(std::is_trivially_copyable<T>::value, "elements are relocated with memcpy");
+
+	public:
+		typedef T value_type;
+		typedef T* iterator;
+		typedef const T* const_iterator;
+
+		explicit _small_vector(memory_resource* resource)
+			: m_data(m_inline), m_size(0), m_capacity(N), m_resource(resource)
+		{}
+
+		_small_vector(const _small_vector& v, memory_resource* resource)
+			: m_data(m_inline), m_size(0), m_capacity(N), m_resource(resource)
+		{
+			assign(v.begin(), v.end());
+		}
+
+		// Takes over v's block, or copies its inline elements. v is left empty.
+		_small_vector(_small_vector&& v)
+			: m_data(m_inline), m_size(0), m_capacity(N), m_resource(v.m_resource)
+		{
+			steal(v);
+		}
+
+		~_small_vector() {
+			release();
+		}
+
+		_small_vector& operator=(const _small_vector& v)
+		{
+			if (this != &v) {
+				assign(v.begin(), v.end());
+			}
+
+			return *this;
+		}
+
+		// Steals v's block only if it can be freed to this vector's resource.
+		_small_vector& operator=(_small_vector&& v)
+		{
+			if (this == &v) {
+				return *this;
+			}
+
+			if (m_resource == v.m_resource || m_resource->is_equal(*v.m_resource))
+			{
+				release();
+				m_data = m_inline;
+				m_capacity = N;
+				m_size = 0;
+				steal(v);
+			}
+			else
+			{
+				assign(v.begin(), v.end());
+				v.clear();
+			}
+
+			return *this;
+		}
+
+		template<class input_iterator>
+		void assign(input_iterator first, input_iterator last)
+		{
+			clear();
+
+			for (; first != last; ++first) {
+				push_back(*first);
+			}
+		}
+
+		std::size_t size() const { return m_size; }
+		bool empty() const { return m_size == 0; }
+		T* data() { return m_data; }
+		const T* data() const { return m_data; }
+		iterator begin() { return m_data; }
+		iterator end() { return m_data + m_size; }
+		const_iterator begin() const { return m_data; }
+		const_iterator end() const { return m_data + m_size; }
+		T& operator[](std::size_t i) { return m_data[i]; }
+		const T& operator[](std::size_t i) const { return m_data[i]; }
+
+		void reserve(std::size_t capacity)
+		{
+			if (capacity <= m_capacity) {
+				return;
+			}
+
+			T* data = static_cast<T*>(m_resource->allocate(capacity * sizeof(T), alignof(T)));
+			std::memcpy(static_cast<void*>(data), m_data, m_size * sizeof(T));
+			release();
+			m_data = data;
+			m_capacity = capacity;
+		}
+
+		void push_back(const T& value)
+		{
+			if (m_size == m_capacity) {
+				T copy = value; // value may live in the storage being reallocated
+				reserve(m_capacity * 2);
+				m_data[m_size++] = copy;
+				return;
+			}
+
+			m_data[m_size++] = value;
+		}
+
+		void insert(std::size_t pos, const T& value)
+		{
+			T copy = value;
+			reserve(m_size + 1 > m_capacity ? m_capacity * 2 : m_capacity);
+			std::memmove(static_cast<void*>(m_data + pos + 1), m_data + pos, (m_size - pos) * sizeof(T));
+			m_data[pos] = copy;
+			++m_size;
+		}
+
+		void erase(std::size_t pos)
+		{
+			std::memmove(static_cast<void*>(m_data + pos), m_data + pos + 1, (m_size - pos - 1) * sizeof(T));
+			--m_size;
+		}
+
+		// Shrinks only; the kept prefix is left as is.
+		void resize(std::size_t size) {
+			if (size < m_size) {
+				m_size = size;
+			}
+		}
+
+		void clear() {
+			m_size = 0;
+		}
+
+	private:
+		void release()
+		{
+			if (m_data != m_inline) {
+				m_resource->deallocate(m_data, m_capacity * sizeof(T), alignof(T));
+			}
+		}
+
+		void steal(_small_vector& v)
+		{
+			if (v.m_data == v.m_inline) {
+				std::memcpy(static_cast<void*>(m_inline), v.m_inline, v.m_size * sizeof(T));
+			}
+			else
+			{
+				m_data = v.m_data;
+				m_capacity = v.m_capacity;
+				v.m_data = v.m_inline;
+				v.m_capacity = N;
+			}
+
+			m_size = v.m_size;
+			v.m_size = 0;
+		}
+	};
+
+	// Immutable connection array published by copy_on_write signals. Connections are
+	// values, so a snapshot owns everything an emitter reads from it.
+	template<class conn_type>
+	struct _connection_snapshot
+	{
+		std::vector<conn_type> m_slots;
+	};
+
+	template<class conn_type, bool enabled>
+	class _snapshot_holder
+	{
+	public:
+		typedef _connection_snapshot<conn_type> snapshot_type;
+
+		const snapshot_type* load() const {
+			return nullptr;
+		}
+
+		template<class list_type>
+		void publish(const list_type&)
+		{}
+	};
+
+	template<class conn_type>
+	class _snapshot_holder<conn_type, true>
+	{
+	public:
+		typedef _connection_snapshot<conn_type> snapshot_type;
+
+		_snapshot_holder()
+			: m_current(nullptr)
+		{}
+
+		~_snapshot_holder() {
+			retire(m_current.load(std::memory_order_relaxed));
+		}
+
+		// Only from inside an _epoch_guard, which keeps the result alive.
+		const snapshot_type* load() const {
+			return m_current.load(std::memory_order_seq_cst);
+		}
+
+		// Called with the signal locked, after every change to the connection list.
+		template<class list_type>
+		void publish(const list_type& connections)
+		{
+			snapshot_type* snapshot = new snapshot_type;
+			snapshot->m_slots.reserve(connections.size());
+
+			for (typename list_type::const_iterator it = connections.begin(); it != connections.end(); ++it)
+			{
+				if (it->m_invoke) {
+					snapshot->m_slots.push_back(*it);
+				}
+			}
+
+			retire(m_current.exchange(snapshot, std::memory_order_seq_cst));
+		}
+
+	private:
+		std::atomic<const snapshot_type*> m_current;
+
+		static void destroy(void* p) {
+			delete static_cast<const snapshot_type*>(p);
+		}
+
+		static void retire(const snapshot_type* snapshot)
+		{
+			if (snapshot) {
+				_epoch_domain::instance().retire(const_cast<snapshot_type*>(snapshot), &destroy);
+			}
+		}
+	};
+
+	template<class mt_policy, class... args_type>
+	struct _signal_bases : public _signal_base<typename _policy_traits<mt_policy>::lock_policy>
+	{
+		typedef _policy_traits<mt_policy> traits;
+		typedef typename traits::lock_policy lock_policy;
+		typedef _connection<lock_policy, args_type...> connection_type;
+		typedef _small_vector<connection_type, SIGSLOT_INLINE_CONNECTIONS> connections_list;
+		typedef _snapshot_holder<connection_type, traits::snapshot_emit> snapshot_holder;
+		typedef typename snapshot_holder::snapshot_type snapshot_type;
+
+		// Slot map behind connection handles. A live slot holds the position of its
+		// connection in m_connected_slots; a free slot holds the next free slot index.
+		struct slot_record
+		{
+			std::uint32_t m_generation;
+			std::uint32_t m_position;
+		};
+
+		typedef _small_vector<slot_record, SIGSLOT_INLINE_CONNECTIONS> slot_map;
+
+		// Something removed connections left behind, to be deleted by m_deleter once no
+		// emission can still reach it. A null m_deleter marks a locked signal's link, which
+		// goes back to the signal's resource.
+		struct deferred
+		{
+			void* m_pointer;
+			void (*m_deleter)(void*);
+		};
+
+		// Disconnecting leaves a tombstone (null m_invoke) so that positions, and with
+		// them invocation order, stay put. Tombstones are squeezed out once they make up
+		// half of the array and no locked emission is walking it.
+		memory_resource* m_resource;
+		connections_list m_connected_slots;
+		slot_map m_slots;
+		std::uint32_t m_free_slot;
+		std::size_t m_tombstones;
+		int m_emitting;
+		std::atomic<std::uint32_t> m_detached; // emissions walking a copy of the list without the lock
+		bool m_unsorted; // a connection made during an emission awaits its place
+		snapshot_holder m_snapshot;
+		_small_vector<deferred, 1> m_deferred; // from m_resource, like the connections
+
+		// Live connections as of the last publish(), read without the lock so that emitting
+		// an empty signal costs one load and a branch. An emission racing a connect may miss
+		// it, as it could have run just before.
+		std::atomic<std::size_t> m_live;
+
+		struct emit_scope
+		{
+			_signal_bases& m_signal;
+
+			explicit emit_scope(_signal_bases& signal)
+				: m_signal(signal)
+			{
+				++m_signal.m_emitting;
+			}
+
+			~emit_scope() {
+				m_signal.end_emission();
+			}
+		};
+
+		// Held by a locked emission for its whole walk: the lock, and an emit_scope so that
+		// slots may change the list under it. A policy with shared_emit lets emitters share
+		// the lock instead; as slots may then not change the signal, no scope is needed.
+		struct exclusive_emit_lock
+		{
+			StaticGuard<lock_policy> m_guard;
+			emit_scope m_scope;
+
+			explicit exclusive_emit_lock(_signal_bases& signal)
+				: m_guard(&signal), m_scope(signal)
+			{}
+		};
+
+		struct shared_emit_lock
+		{
+			SharedGuard<lock_policy> m_guard;
+
+			explicit shared_emit_lock(_signal_bases& signal)
+				: m_guard(&signal)
+			{}
+		};
+
+		// A locked emission that copies the live connections under the lock and walks the
+		// copy without it, so that its slots may take any lock, this signal's included.
+		// Until it ends, removed connections keep their links and targets, and calls check
+		// and count on the link where there is one. The emission itself is counted in
+		// m_detached, for disconnect_and_wait() on a connection without a link. The copy
+		// comes from the signal's resource, inline up to SIGSLOT_INLINE_CONNECTIONS.
+		struct detached_emit_scope
+		{
+			_signal_bases& m_signal;
+			_call_frame m_frame;
+			connections_list m_slots;
+
+			explicit detached_emit_scope(_signal_bases& signal)
+				: m_signal(signal), m_frame(&signal.m_detached), m_slots(signal.m_resource)
+			{
+				StaticGuard<lock_policy> guard(&m_signal);
+				m_slots.reserve(m_signal.m_connected_slots.size() - m_signal.m_tombstones);
+
+				for (std::size_t i = 0; i < m_signal.m_connected_slots.size(); ++i)
+				{
+					if (m_signal.m_connected_slots[i].m_invoke) {
+						m_slots.push_back(m_signal.m_connected_slots[i]);
+					}
+				}
+
+				++m_signal.m_emitting;
+			}
+
+			~detached_emit_scope()
+			{
+				StaticGuard<lock_policy> guard(&m_signal);
+				m_signal.end_emission();
+			}
+
+			detached_emit_scope(const detached_emit_scope&) = delete;
+			detached_emit_scope& operator=(const detached_emit_scope&) = delete;
+		};
+
+		typedef typename std::conditional<traits::shared_emit, shared_emit_lock, exclusive_emit_lock>::type emit_lock;
+
+		explicit _signal_bases(memory_resource* resource)
+			: m_resource(resource), m_connected_slots(resource), m_slots(resource),
+			  m_free_slot(connection::npos), m_tombstones(0), m_emitting(0), m_detached(0), m_unsorted(false),
+			  m_deferred(resource), m_live(0)
+		{}
+
+		// Like a pmr container, the copy allocates from the resource it is given, not the
+		// source's. The connections follow from copy_connections(), and from
+		// take_connections() for the move, which the derived signal calls once it is
+		// complete: either makes it reachable from its receivers, which may call it at once.
+		_signal_bases(const _signal_bases<mt_policy, args_type...>& s, memory_resource* resource)
+			: _signal_base<lock_policy>(s), m_resource(resource), m_connected_slots(resource), m_slots(resource),
+			  m_free_slot(connection::npos), m_tombstones(0), m_emitting(0), m_detached(0), m_unsorted(false),
+			  m_deferred(resource), m_live(0)
+		{}
+
+		// Takes over s's connections, handles included, from the same resource. The links
+		// stay where they are and are only re-pointed at this signal; s is left with none.
+		// s must not be emitting. Only a copy_on_write signal allocates, to publish.
+		_signal_bases(_signal_bases<mt_policy, args_type...>&& s) noexcept(!traits::snapshot_emit)
+			: _signal_base<lock_policy>(s), m_resource(s.m_resource), m_connected_slots(s.m_resource), m_slots(s.m_resource),
+			  m_free_slot(connection::npos), m_tombstones(0), m_emitting(0), m_detached(0), m_unsorted(false),
+			  m_deferred(s.m_resource), m_live(0)
+		{}
+
+		// Drops this signal's connections and takes over s's. This signal keeps its own
+		// resource; if s's differs, its links are reallocated from this one.
+		_signal_bases& operator=(_signal_bases<mt_policy, args_type...>&& s)
+		{
+			if (this != &s)
+			{
+				disconnect_all();
+				take_connections(s);
+			}
+
+			return *this;
+		}
+
+		// Takes over the connection a compact signal held on its own, as the first of this
+		// signal, which no other thread can reach yet. A live one keeps its handle,
+		// connection(0, 0); a disconnected one leaves that handle spent. Expects the
+		// compact signal locked.
+		void adopt(const connection_type& conn, bool live)
+		{
+			slot_record slot = { live ? 0u : 1u, live ? 0u : connection::npos };
+			m_slots.push_back(slot);
+
+			if (!live)
+			{
+				m_free_slot = 0;
+				return;
+			}
+
+			m_connected_slots.push_back(conn);
+
+			if (basic_has_slots<lock_policy>* pdest = conn.getdest())
+			{
+				StaticGuard<lock_policy> receiver(pdest);
+				conn.m_link->m_signal = this;
+			}
+			else if (conn.m_link) {
+				conn.m_link->m_signal = this;
+			}
+
+			publish();
+		}
+
+		void slot_duplicate(const _connection_link<lock_policy>* plink, basic_has_slots<lock_policy>* newtarget)
+		{
+			StaticGuard<lock_policy> guard(this);
+			duplicate_link(plink, newtarget);
+		}
+
+		// slot_duplicate() and slot_relocate() for a signal that no other thread can reach
+		// yet, whose lock they need not take.
+		void duplicate_link(const _connection_link<lock_policy>* plink, basic_has_slots<lock_policy>* newtarget)
+		{
+			const connection_type& conn = m_connected_slots[m_slots[plink->m_slot].m_position];
+
+			if (plink->m_target)
+			{
+				_slot_target<lock_policy>* target = plink->m_target->duplicate(newtarget, target_resource());
+				connection_type copy = conn;
+				copy.m_object = target;
+				insert(copy, newtarget, target);
+			}
+			else {
+				insert(conn.duplicate(newtarget), newtarget);
+			}
+
+			publish();
+		}
+
+		// Disconnects waiting on calls through removed links hold them until they are done.
+		~_signal_bases()
+		{
+			disconnect_all();
+			this->wait_for_waiters();
+			release_deferred();
+		}
+
+		void disconnect_all()
+		{
+			_ordered_guard<lock_policy> guard(this, nullptr, [this](_lock_set<lock_policy>& objects) { add_receivers(objects); });
+
+			for (std::size_t i = 0; i < m_connected_slots.size(); ++i)
+			{
+				if (m_connected_slots[i].m_invoke) {
+					unlink(i);
+				}
+			}
+
+			compact();
+			publish();
+		}
+
+		void disconnect(basic_has_slots<lock_policy>* pclass)
+		{
+			_ordered_guard<lock_policy> guard(this, pclass);
+
+			for (std::size_t i = 0; i < m_connected_slots.size(); ++i)
+			{
+				if (m_connected_slots[i].m_invoke && m_connected_slots[i].getdest() == pclass)
+				{
+					unlink(i);
+					compact();
+					publish();
+					return;
+				}
+			}
+		}
+
+		// O(1): the handle leads straight to the connection. Returns false for a handle
+		// that was already disconnected. A handle from an unrelated signal is a programming
+		// error, and may name one of this signal's own connections; one issued by the
+		// signal this one was copied from names the copied connection.
+		bool disconnect(connection conn)
+		{
+			_ordered_guard<lock_policy> guard(this, nullptr, [this, conn](_lock_set<lock_policy>& objects) { add_receiver(find(conn), objects); });
+			std::size_t position = find(conn);
+
+			if (position == connection::npos) {
+				return false;
+			}
+
+			unlink(position);
+			compact();
+			publish();
+			return true;
+		}
+
+		bool connected(connection conn)
+		{
+			StaticGuard<lock_policy> guard(this);
+			return find(conn) != connection::npos;
+		}
+
+		// Disconnects like disconnect(conn), then waits until no call through the connection
+		// is running on another thread. Locked emissions hold the signal lock for their
+		// whole walk, so only copy_on_write and striped signals, and locked ones in an
+		// emit_parallel(), ever wait, and only for calls of this connection, not for the calling thread's
+		// own; a queued slot already running in its dispatcher is not waited for. A callable
+		// stored inline in a locked signal has no link to count its calls on, so for it the
+		// parallel emissions are waited out whole, which a slot running on the pool's
+		// threads must not do.
+		bool disconnect_and_wait(connection conn)
+		{
+			// Keeps a removed copy_on_write link readable for the wait.
+			_epoch_guard epoch;
+			const std::atomic<std::uint32_t>* calls = nullptr;
+
+			{
+				_ordered_guard<lock_policy> guard(this, nullptr, [this, conn](_lock_set<lock_policy>& objects) { add_receiver(find(conn), objects); });
+				std::size_t position = find(conn);
+
+				if (position == connection::npos) {
+					return false;
+				}
+
+				if (detached_emitters())
+				{
+					_connection_link<lock_policy>* plink = m_connected_slots[position].m_link;
+					calls = plink ? &plink->m_calls : &m_detached;
+					this->m_waiters.fetch_add(1, std::memory_order_relaxed);
+				}
+
+				unlink(position);
+				compact();
+				publish();
+			}
+
+			if (calls)
+			{
+				_call_frame::wait(*calls);
+				this->end_wait();
+				StaticGuard<lock_policy> guard(this);
+				release_deferred();
+			}
+
+			return true;
+		}
+
+		// O(1): the link names its slot.
+		void slot_relocate(_connection_link<lock_policy>* plink, basic_has_slots<lock_policy>* pnewdest)
+		{
+			StaticGuard<lock_policy> guard(this);
+			relocate_link(plink, pnewdest);
+		}
+
+		// See duplicate_link().
+		void relocate_link(_connection_link<lock_policy>* plink, basic_has_slots<lock_policy>* pnewdest)
+		{
+			connection_type& conn = m_connected_slots[m_slots[plink->m_slot].m_position];
+
+			if (plink->m_target) {
+				plink->m_target->relocate(pnewdest);
+			}
+			else {
+				conn.repoint(plink->m_dest, pnewdest);
+			}
+
+			plink->m_dest = pnewdest;
+			publish();
+		}
+
+		// O(1): the link names its slot.
+		bool slot_disconnect(_connection_link<lock_policy>* plink, bool wait)
+		{
+			StaticGuard<lock_policy> guard(this);
+			bool running = (wait || traits::detached_emit) && detached_emitters();
+
+			if (running) {
+				this->m_waiters.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			remove(m_slots[plink->m_slot].m_position);
+			free_link(plink);
+			compact();
+			publish();
+			return running;
+		}
+
+	protected:
+		// The copy keeps the source's slot layout, so handles are interchangeable. s is read
+		// under its lock, as other threads may be rewiring it.
+		void copy_connections(const _signal_bases<mt_policy, args_type...>& s)
+		{
+			_ordered_guard<lock_policy> guard(const_cast<_signal_bases*>(&s), this, [&s](_lock_set<lock_policy>& objects) { s.add_receivers(objects); });
+			m_connected_slots = s.m_connected_slots;
+			m_slots = s.m_slots;
+			m_free_slot = s.m_free_slot;
+			m_tombstones = s.m_tombstones;
+
+			for (std::size_t i = 0; i < m_connected_slots.size(); ++i)
+			{
+				connection_type& conn = m_connected_slots[i];
+
+				if (!conn.m_link) {
+					continue;
+				}
+
+				basic_has_slots<lock_policy>* pdest = conn.m_link->m_dest;
+				_slot_target<lock_policy>* target = conn.m_link->m_target;
+
+				if (target)
+				{
+					target = target->duplicate(pdest, target_resource());
+					conn.m_object = target;
+				}
+
+				conn.m_link = link(pdest, conn.m_slot, target);
+			}
+
+			publish();
+		}
+
+		void take_connections(_signal_bases& s)
+		{
+			_ordered_guard<lock_policy> guard(this, &s, [&s](_lock_set<lock_policy>& objects) { s.add_receivers(objects); });
+			bool relink = !traits::snapshot_emit && m_resource != s.m_resource && !m_resource->is_equal(*s.m_resource);
+
+			m_connected_slots = std::move(s.m_connected_slots);
+			m_slots = std::move(s.m_slots);
+			m_free_slot = s.m_free_slot;
+			m_tombstones = s.m_tombstones;
+			s.m_free_slot = connection::npos;
+			s.m_tombstones = 0;
+
+			for (std::size_t i = 0; i < m_connected_slots.size(); ++i)
+			{
+				connection_type& conn = m_connected_slots[i];
+				_connection_link<lock_policy>* plink = conn.m_link;
+
+				if (!plink) {
+					continue;
+				}
+
+				basic_has_slots<lock_policy>* pdest = plink->m_dest;
+
+				if (relink)
+				{
+					conn.m_link = link(pdest, plink->m_slot, plink->m_target);
+
+					if (pdest) {
+						pdest->signal_disconnect(plink);
+					}
+
+					s.m_resource->deallocate(plink, sizeof(_connection_link<lock_policy>), alignof(_connection_link<lock_policy>));
+				}
+				else if (pdest)
+				{
+					// The receiver reads m_signal under its own lock.
+					StaticGuard<lock_policy> receiver(pdest);
+					plink->m_signal = this;
+				}
+				else {
+					plink->m_signal = this;
+				}
+			}
+
+			s.publish();
+			publish();
+		}
+
+		// The helpers below expect the signal to be locked.
+
+		// Receivers that unlinking or relinking connections will lock, for an _ordered_guard
+		// to take along with the signal.
+		void add_receivers(_lock_set<lock_policy>& objects) const
+		{
+			for (std::size_t i = 0; i < m_connected_slots.size(); ++i) {
+				add_receiver(i, objects);
+			}
+		}
+
+		void add_receiver(std::size_t position, _lock_set<lock_policy>& objects) const
+		{
+			if (position != connection::npos && m_connected_slots[position].m_link && m_connected_slots[position].m_link->m_dest) {
+				objects.add(m_connected_slots[position].m_link->m_dest);
+			}
+		}
+
+		connection insert(connection_type conn, basic_has_slots<lock_policy>* pdest, _slot_target<lock_policy>* target = nullptr)
+		{
+			std::uint32_t index = m_free_slot;
+
+			if (index == connection::npos)
+			{
+				index = static_cast<std::uint32_t>(m_slots.size());
+				slot_record slot = { 0, 0 };
+				m_slots.push_back(slot);
+			}
+			else {
+				m_free_slot = m_slots[index].m_position;
+			}
+
+			conn.m_slot = index;
+			conn.m_link = pdest || target || traits::snapshot_emit ? link(pdest, index, target) : nullptr;
+			place(conn);
+			return connection(index, m_slots[index].m_generation);
+		}
+
+		// Connections of equal priority are appended, so the usual connect stays O(1); a
+		// higher priority one is inserted ahead of the first lower one, shifting the rest.
+		// A locked emission walking the list must not see it shift, so while one is under
+		// way the connection is appended and the list sorted once the emission returns.
+		void place(const connection_type& conn)
+		{
+			std::size_t position = m_connected_slots.size();
+
+			while (position > 0 && m_connected_slots[position - 1].m_priority < conn.m_priority) {
+				--position;
+			}
+
+			if (position == m_connected_slots.size() || m_emitting != 0)
+			{
+				m_unsorted = m_unsorted || position != m_connected_slots.size();
+				m_slots[conn.m_slot].m_position = static_cast<std::uint32_t>(m_connected_slots.size());
+				m_connected_slots.push_back(conn);
+				return;
+			}
+
+			m_connected_slots.insert(position, conn);
+			reindex(position);
+		}
+
+		// Whether emissions may be calling through this signal without its lock.
+		bool detached_emitters() const {
+			return traits::snapshot_emit || m_detached.load(std::memory_order_relaxed) != 0;
+		}
+
+		// The outermost emission puts the list back in order once it is done.
+		void end_emission()
+		{
+			if (--m_emitting == 0)
+			{
+				sort();
+				compact();
+				release_deferred();
+			}
+		}
+
+		// Tombstones keep their priority, so sorting leaves them where they belong too.
+		void sort()
+		{
+			if (m_emitting != 0 || !m_unsorted) {
+				return;
+			}
+
+			std::stable_sort(m_connected_slots.begin(), m_connected_slots.end(), &higher_priority);
+			reindex(0);
+			m_unsorted = false;
+		}
+
+		static bool higher_priority(const connection_type& a, const connection_type& b) {
+			return a.m_priority > b.m_priority;
+		}
+
+		// A tombstone's slot may have been reused, so only live entries own theirs.
+		void reindex(std::size_t first)
+		{
+			for (std::size_t i = first; i < m_connected_slots.size(); ++i)
+			{
+				if (m_connected_slots[i].m_invoke) {
+					m_slots[m_connected_slots[i].m_slot].m_position = static_cast<std::uint32_t>(i);
+				}
+			}
+		}
+
+		// Callable targets come from m_resource like the links, and for the same reason as
+		// below from the heap under copy_on_write.
+		memory_resource* target_resource() const {
+			return traits::snapshot_emit ? _heap_resource() : m_resource;
+		}
+
+		// copy_on_write emitters read links, which are then reclaimed through the epoch
+		// domain from whichever thread retires next, so they come from the default heap.
+		_connection_link<lock_policy>* link(basic_has_slots<lock_policy>* pdest, std::uint32_t slot, _slot_target<lock_policy>* target)
+		{
+			_connection_link<lock_policy>* plink;
+
+			if (traits::snapshot_emit) {
+				plink = new _connection_link<lock_policy>();
+			}
+			else {
+				void* p = m_resource->allocate(sizeof(_connection_link<lock_policy>), alignof(_connection_link<lock_policy>));
+				plink = new (p) _connection_link<lock_policy>();
+			}
+
+			plink->m_signal = this;
+			plink->m_dest = pdest;
+			plink->m_target = target;
+			plink->m_slot = slot;
+			plink->m_connected.store(true, std::memory_order_relaxed);
+			plink->m_calls.store(0, std::memory_order_relaxed);
+
+			if (pdest) {
+				pdest->signal_connect(plink);
+			}
+
+			return plink;
+		}
+
+		// Removes the connection at position and takes it off its receiver's list. A
+		// callable stored inline in a locked signal has no link at all.
+		void unlink(std::size_t position)
+		{
+			_connection_link<lock_policy>* plink = m_connected_slots[position].m_link;
+
+			if (plink && plink->m_dest) {
+				plink->m_dest->signal_disconnect(plink);
+			}
+
+			remove(position);
+
+			if (plink) {
+				free_link(plink);
+			}
+		}
+
+		void free_link(_connection_link<lock_policy>* plink)
+		{
+			plink->m_connected.store(false, std::memory_order_seq_cst);
+
+			if (plink->m_target) {
+				plink->m_target->disconnect();
+			}
+
+			if (traits::snapshot_emit) {
+				defer(plink, &destroy_link);
+				return;
+			}
+
+			// A detached emission still checks the link; others only call the target.
+			if (m_detached.load(std::memory_order_relaxed) != 0) {
+				defer(plink, nullptr);
+				return;
+			}
+
+			if (plink->m_target) {
+				defer(plink->m_target, &release_target);
+			}
+
+			deallocate_link(plink);
+		}
+
+		void deallocate_link(_connection_link<lock_policy>* plink) {
+			m_resource->deallocate(plink, sizeof(_connection_link<lock_policy>), alignof(_connection_link<lock_policy>));
+		}
+
+		std::size_t find(connection conn) const
+		{
+			if (conn.index() >= m_slots.size()) {
+				return connection::npos;
+			}
+
+			// A free slot's m_position links the free list, so a handle that matches a free
+			// slot's generation (a stale, copied or foreign one) must not be taken at its word:
+			// the position has to hold a live connection that owns this slot.
+			const slot_record& slot = m_slots[conn.index()];
+
+			if (slot.m_generation != conn.generation() || slot.m_position >= m_connected_slots.size()) {
+				return connection::npos;
+			}
+
+			const connection_type& target = m_connected_slots[slot.m_position];
+
+			if (!target.m_invoke || target.m_slot != conn.index()) {
+				return connection::npos;
+			}
+
+			return slot.m_position;
+		}
+
+		void remove(std::size_t position)
+		{
+			connection_type& conn = m_connected_slots[position];
+			slot_record& slot = m_slots[conn.m_slot];
+
+			++slot.m_generation;
+			slot.m_position = m_free_slot;
+			m_free_slot = conn.m_slot;
+
+			conn.m_invoke = nullptr;
+			conn.m_link = nullptr;
+			++m_tombstones;
+		}
+
+		// Publishes the current connections to copy_on_write emitters, then lets go of what
+		// removed connections left behind.
+		void publish()
+		{
+			m_live.store(m_connected_slots.size() - m_tombstones, std::memory_order_relaxed);
+			m_snapshot.publish(m_connected_slots);
+			release_deferred();
+		}
+
+		void defer(void* p, void (*deleter)(void*))
+		{
+			deferred item = { p, deleter };
+			m_deferred.push_back(item);
+		}
+
+		// A removed connection's target may still be in use: by the slot that removed it,
+		// by a locked emission further up the stack, or by a copy_on_write emitter holding
+		// an older snapshot. Locked signals release it once the outermost emission returns,
+		// along with the whole link while a detached emission may still read it, and once
+		// no disconnect is still waiting on a link's calls; one that a receiver waited on is
+		// let go of by the next change to the signal, or its destruction. copy_on_write
+		// signals retire the whole link to the epoch domain after the snapshot that no
+		// longer refers to it is published, so it outlives every emitter that could still
+		// call through it, and every waiter, which waits inside an epoch.
+		void release_deferred()
+		{
+			if (traits::snapshot_emit)
+			{
+				for (std::size_t i = 0; i < m_deferred.size(); ++i) {
+					_epoch_domain::instance().retire(m_deferred[i].m_pointer, m_deferred[i].m_deleter);
+				}
+			}
+			else if (m_emitting == 0 && this->m_waiters.load(std::memory_order_acquire) == 0)
+			{
+				for (std::size_t i = 0; i < m_deferred.size(); ++i)
+				{
+					if (m_deferred[i].m_deleter) {
+						m_deferred[i].m_deleter(m_deferred[i].m_pointer);
+						continue;
+					}
+
+					// A whole link, held back for a detached emission.
+					_connection_link<lock_policy>* plink = static_cast<_connection_link<lock_policy>*>(m_deferred[i].m_pointer);
+
+					if (plink->m_target) {
+						plink->m_target->release();
+					}
+
+					deallocate_link(plink);
+				}
+			}
+			else {
+				return;
+			}
+
+			m_deferred.clear();
+		}
+
+		static void release_target(void* p) {
+			static_cast<_slot_target<lock_policy>*>(p)->release();
+		}
+
+		static void destroy_link(void* p)
+		{
+			_connection_link<lock_policy>* plink = static_cast<_connection_link<lock_policy>*>(p);
+
+			if (plink->m_target) {
+				plink->m_target->release();
+			}
+
+			delete plink;
+		}
+
+		void compact()
+		{
+			if (m_emitting != 0 || m_tombstones * 2 < m_connected_slots.size()) {
+				return;
+			}
+
+			std::size_t kept = 0;
+
+			for (std::size_t i = 0; i < m_connected_slots.size(); ++i)
+			{
+				if (m_connected_slots[i].m_invoke)
+				{
+					m_slots[m_connected_slots[i].m_slot].m_position = static_cast<std::uint32_t>(kept);
+					m_connected_slots[kept++] = m_connected_slots[i];
+				}
+			}
+
+			m_connected_slots.resize(kept);
+			m_tombstones = 0;
+		}
+	};
+
+	// basic_signals<mt_policy, args...> picks its threading policy explicitly;
+	// signals<args...> uses SIGSLOT_DEFAULT_MT_POLICY.
+	template<class mt_policy, typename... args_type>
+	class basic_signals : public _signal_bases<mt_policy, args_type...>
+	{
+		typedef _signal_bases<mt_policy, args_type...> base_type;
+		typedef typename base_type::lock_policy lock_policy;
+
+	public:
+		basic_signals()
+			: base_type(get_default_resource())
+		{}
+
+		// Connection storage and links come from resource, which must outlive the signal and
+		// be usable from whichever thread connects or disconnects. copy_on_write snapshots
+		// and links are reclaimed from whichever thread retires memory next and so always
+		// use the default heap.
+		explicit basic_signals(memory_resource* resource)
+			: base_type(resource)
+		{}
+
+		basic_signals(const basic_signals<mt_policy, args_type...>& s)
+			: base_type(s, get_default_resource())
+		{
+			base_type::copy_connections(s);
+		}
+
+		basic_signals(const basic_signals<mt_policy, args_type...>& s, memory_resource* resource)
+			: base_type(s, resource)
+		{
+			base_type::copy_connections(s);
+		}
+
+		basic_signals(basic_signals<mt_policy, args_type...>&& s) noexcept(!base_type::traits::snapshot_emit)
+			: base_type(std::move(s))
+		{
+			base_type::take_connections(s);
+		}
+
+		// Receivers tearing down may call the signal until it has let go of them.
+		~basic_signals() {
+			base_type::disconnect_all();
+		}
+
+		basic_signals& operator=(basic_signals<mt_policy, args_type...>&& s)
+		{
+			base_type::operator=(std::move(s));
+			return *this;
+		}
+
+		memory_resource* get_memory_resource() const {
+			return base_type::m_resource;
+		}
+
+		// The slot's parameters need only be initialisable from the signal's arguments, so
+		// a signals<std::string> can call a slot taking const std::string&.
+		template<class desttype, class... slot_args>
+		connection connect(desttype* pclass, void (desttype::* pmemfun)(slot_args...), priority order = priority())
+		{
+			return connect(pclass, _connection_thunks<desttype, lock_policy, _type_list<args_type...>, _type_list<slot_args...> >::make(pclass, pmemfun), nullptr, order);
+		}
+
+		// Queued connection: each emission copies the arguments and posts the call to queue,
+		// and the slot runs when the queue's owner calls dispatch(). Calls still pending when
+		// the connection goes away are dropped.
+		template<class desttype, class... slot_args>
+		connection connect(desttype* pclass, void (desttype::* pmemfun)(slot_args...), dispatcher& queue, priority order = priority())
+		{
+			typedef _queued_slot<lock_policy, args_type...> queued_type;
+			queued_type* queued = new queued_type(&queue,
+				_connection_thunks<desttype, lock_policy, _type_list<args_type...>, _type_list<slot_args...> >::make(pclass, pmemfun), pclass);
+			return connect(pclass, queued->make_connection(), queued, order);
+		}
+
+		// Conflated connection: like a queued one, but at most one call is pending. Values
+		// emitted before the queue's owner calls dispatch() replace the pending ones, so the
+		// slot runs at the receiver's pace and only sees the latest values.
+		template<class desttype, class... slot_args>
+		connection connect_latest(desttype* pclass, void (desttype::* pmemfun)(slot_args...), dispatcher& queue, priority order = priority())
+		{
+			typedef _latest_values<std::tuple<typename std::decay<args_type>::type...> > values_type;
+			return connect_conflated(pclass, pmemfun, queue, values_type(), order);
+		}
+
+		// As above, but keeps the latest values for each distinct key(args...), delivered in
+		// the order the keys first appeared since the last dispatch(). The key must be
+		// hashable with std::hash.
+		template<class desttype, class... slot_args, class key_function>
+		connection connect_latest(desttype* pclass, void (desttype::* pmemfun)(slot_args...), dispatcher& queue, key_function key, priority order = priority())
+		{
+			typedef _keyed_values<std::tuple<typename std::decay<args_type>::type...>, key_function> values_type;
+			return connect_conflated(pclass, pmemfun, queue, values_type(key), order);
+		}
+
+		// Connects a lambda, function pointer or other function object, called with the
+		// signal's arguments. It has no receiver, so it stays connected until disconnected
+		// through the returned handle or the signal goes away.
+		template<class functor>
+		connection connect(functor&& f, priority order = priority())
+		{
+			typedef _callable_thunks<typename std::decay<functor>::type, lock_policy, args_type...> thunks;
+			connection_type conn;
+			_slot_target<lock_policy>* target = thunks::make(conn, std::forward<functor>(f), base_type::target_resource());
+			return connect(nullptr, conn, target, order);
+		}
+
+#if __cplusplus >= 201703L
+		// connect<&desttype::method>(pclass) binds the member function at compile time,
+		// so the thunk calls it directly instead of through a member function pointer.
+		template<auto pmemfun, class desttype>
+		connection connect(desttype* pclass, priority order = priority())
+		{
+			typedef _connection_thunks<desttype, lock_policy, _type_list<args_type...>, typename _memfun_args<decltype(pmemfun)>::type> thunks;
+			return connect(pclass, thunks::template make_static<pmemfun>(pclass), nullptr, order);
+		}
+#endif
+
+		// Arguments are converted once and handed to every slot by const reference, so a
+		// slot taking const T& never sees a copy. When every argument is an rvalue, the last
+		// slot receives them as rvalues and a by-value parameter is moved into.
+		template<class... call_args>
+		void emit(call_args&&... args)
+		{
+			if (base_type::m_live.load(std::memory_order_relaxed) == 0) {
+				return;
+			}
+
+			emit_args(std::integral_constant<bool, _all_of<!std::is_lvalue_reference<call_args>::value...>::value>(),
+				std::forward<call_args>(args)...);
+		}
+
+		template<class... call_args>
+		void operator()(call_args&&... args)
+		{
+			emit(std::forward<call_args>(args)...);
+		}
+
+		// Lock-free and cheap, for guarding work that only matters to a receiver. Racing a
+		// connect or disconnect on another thread, either answer may come back.
+		bool has_receivers() const {
+			return base_type::m_live.load(std::memory_order_relaxed) != 0;
+		}
+
+		// Calls factory, which returns a std::tuple of the arguments, only if something is
+		// connected, then emits them as rvalues. Expensive arguments are never built for a
+		// signal nobody listens to.
+		template<class factory>
+		void emit_lazy(factory f)
+		{
+			if (has_receivers()) {
+				emit_tuple(f(), typename _make_index_list<sizeof...(args_type)>::type());
+			}
+		}
+
+		// Emits every element of [first, last), each a std::tuple of the signal's arguments,
+		// calling one slot over the whole batch before moving on to the next. Each slot sees
+		// the elements in order, but they are no longer interleaved with the other slots, so
+		// a slot's working set stays warm across the batch. A slot disconnected partway
+		// through misses the rest of the batch.
+		template<class iterator>
+		void emit_batch(iterator first, iterator last)
+		{
+			if (first == last || base_type::m_live.load(std::memory_order_relaxed) == 0) {
+				return;
+			}
+
+			if (base_type::traits::snapshot_emit)
+			{
+				_epoch_guard epoch;
+				const typename base_type::snapshot_type* snapshot = base_type::m_snapshot.load();
+
+				if (snapshot) {
+					invoke_batch(std::true_type(), snapshot->m_slots, snapshot->m_slots.size(), first, last);
+				}
+
+				return;
+			}
+
+			if (base_type::traits::detached_emit)
+			{
+				typename base_type::detached_emit_scope scope(*this);
+				invoke_batch(_detached_walk(), scope.m_slots, scope.m_slots.size(), first, last);
+				return;
+			}
+
+			typename base_type::emit_lock lock(*this);
+			invoke_batch(std::false_type(), base_type::m_connected_slots, base_type::m_connected_slots.size(), first, last);
+		}
+
+		// Any container or view of argument tuples: std::vector, std::array, std::span...
+		template<class batch_type>
+		void emit_batch(const batch_type& batch) {
+			emit_batch(batch.begin(), batch.end());
+		}
+
+#ifndef SIGSLOT_PURE_ISO
+		// Like emit(), but from pool.threshold() connections up the slots are called in
+		// chunks on the pool's threads, in no particular order. Every slot receives the same
+		// arguments by const reference, possibly concurrently, and the call returns when all
+		// have run. The first exception a slot throws is rethrown here.
+		//
+		// Locked signals are not held locked meanwhile: they are walked from a copy, as
+		// copy_on_write signals are from a snapshot. Slots may connect and disconnect
+		// anything, but a disconnect does not stop a call already running, so a receiver
+		// that may be destroyed during the emission calls disconnect_all_and_wait() first,
+		// as it would for copy_on_write.
+		template<class... call_args>
+		void emit_parallel(thread_pool& pool, call_args&&... args)
+		{
+			if (base_type::m_live.load(std::memory_order_relaxed) != 0) {
+				emit_parallel_copy(pool, std::forward<call_args>(args)...);
+			}
+		}
+#endif
+
+	private:
+		typedef typename base_type::connection_type connection_type;
+
+		template<class tuple_type, std::size_t... indices>
+		void emit_tuple(tuple_type&& values, _index_list<indices...>) {
+			emit(std::get<indices>(std::move(values))...);
+		}
+
+		template<class desttype, class... slot_args, class values_type>
+		connection connect_conflated(desttype* pclass, void (desttype::* pmemfun)(slot_args...), dispatcher& queue, values_type values, priority order)
+		{
+			typedef _conflated_slot<lock_policy, values_type, args_type...> conflated_type;
+			conflated_type* conflated = new conflated_type(&queue,
+				_connection_thunks<desttype, lock_policy, _type_list<args_type...>, _type_list<slot_args...> >::make(pclass, pmemfun), pclass, std::move(values));
+			return connect(pclass, conflated->make_connection(), conflated, order);
+		}
+
+		template<class... call_args>
+		void emit_args(std::false_type, call_args&&... args) {
+			emit_copy(std::forward<call_args>(args)...);
+		}
+
+		template<class... call_args>
+		void emit_args(std::true_type, call_args&&... args) {
+			emit_move(std::forward<call_args>(args)...);
+		}
+
+		void emit_copy(typename _arg<args_type>::type... args)
+		{
+			if (base_type::traits::snapshot_emit)
+			{
+				// Slots run without the lock, from a snapshot that cannot change under us.
+				_epoch_guard epoch;
+				const typename base_type::snapshot_type* snapshot = base_type::m_snapshot.load();
+
+				if (snapshot) {
+					invoke(std::true_type(), snapshot->m_slots, snapshot->m_slots.size(), args...);
+				}
+
+				return;
+			}
+
+			if (base_type::traits::detached_emit)
+			{
+				typename base_type::detached_emit_scope scope(*this);
+				invoke(_detached_walk(), scope.m_slots, scope.m_slots.size(), args...);
+				return;
+			}
+
+			typename base_type::emit_lock lock(*this);
+			invoke(std::false_type(), base_type::m_connected_slots, base_type::m_connected_slots.size(), args...);
+		}
+
+		void emit_move(typename _arg<args_type>::rvalue... args)
+		{
+			if (base_type::traits::snapshot_emit)
+			{
+				_epoch_guard epoch;
+				const typename base_type::snapshot_type* snapshot = base_type::m_snapshot.load();
+
+				if (snapshot) {
+					invoke_move(std::true_type(), snapshot->m_slots, snapshot->m_slots.size(), std::forward<typename _arg<args_type>::rvalue>(args)...);
+				}
+
+				return;
+			}
+
+			if (base_type::traits::detached_emit)
+			{
+				typename base_type::detached_emit_scope scope(*this);
+				invoke_move(_detached_walk(), scope.m_slots, scope.m_slots.size(), std::forward<typename _arg<args_type>::rvalue>(args)...);
+				return;
+			}
+
+			typename base_type::emit_lock lock(*this);
+			invoke_move(std::false_type(), base_type::m_connected_slots, base_type::m_connected_slots.size(), std::forward<typename _arg<args_type>::rvalue>(args)...);
+		}
+
+#ifndef SIGSLOT_PURE_ISO
+		void emit_parallel_copy(thread_pool& pool, typename _arg<args_type>::type... args)
+		{
+			if (base_type::traits::snapshot_emit)
+			{
+				// The pool's threads run inside this thread's epoch.
+				_epoch_guard epoch;
+				const typename base_type::snapshot_type* snapshot = base_type::m_snapshot.load();
+
+				if (snapshot) {
+					invoke_parallel(pool, std::true_type(), snapshot->m_slots, snapshot->m_slots.size(), args...);
+				}
+
+				return;
+			}
+
+			// Holding the lock while the pool works would block any slot that needs it, and
+			// under multi_threaded_global that is every slot touching another signal or
+			// receiver; the walk goes over a copy instead.
+			typename base_type::detached_emit_scope scope(*this);
+			invoke_parallel(pool, _detached_walk(), scope.m_slots, scope.m_slots.size(), args...);
+		}
+
+		template<class checked, class list_type>
+		static void invoke_parallel(thread_pool& pool, checked, const list_type& list, std::size_t count, typename _arg<args_type>::type... args)
+		{
+			if (count < pool.threshold()) {
+				invoke(checked(), list, count, args...);
+				return;
+			}
+
+			pool.parallel_for(count, [&](std::size_t first, std::size_t last) {
+				for (std::size_t i = first; i < last; ++i)
+				{
+					const connection_type& conn = list[i];
+
+					if (conn.m_invoke) {
+						call(checked(), conn, args...);
+					}
+				}
+			});
+		}
+#endif
+
+		// Calls the first count connections in order, skipping tombstones. Connections made
+		// by a slot during the walk take effect from the next emission. The list is indexed
+		// afresh on every step, since such a connection may reallocate it. checked is true
+		// for copy_on_write emission, whose calls check their link's connected flag.
+		template<class checked, class list_type>
+		static void invoke(checked, const list_type& list, std::size_t count, typename _arg<args_type>::type... args)
+		{
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				const connection_type& conn = list[i];
+
+				if (conn.m_invoke) {
+					call(checked(), conn, args...);
+				}
+			}
+		}
+
+		// Per connection, the list is indexed afresh for each element as in invoke().
+		template<class list_type, class iterator>
+		static void invoke_batch(std::false_type, const list_type& list, std::size_t count, iterator first, iterator last)
+		{
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				for (iterator it = first; it != last && list[i].m_invoke; ++it) {
+					call_element(list[i], *it, typename _make_index_list<sizeof...(args_type)>::type());
+				}
+			}
+		}
+
+		// The connected flag is checked before each element, where there is a link.
+		template<class checked, class list_type, class iterator>
+		static void invoke_batch(checked, const list_type& list, std::size_t count, iterator first, iterator last)
+		{
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				const connection_type& conn = list[i];
+
+				if (!conn.m_invoke) {
+					continue;
+				}
+
+				_call_frame frame(conn.m_link ? &conn.m_link->m_calls : nullptr);
+
+				for (iterator it = first; it != last && (!conn.m_link || conn.m_link->connected()); ++it) {
+					call_element(conn, *it, typename _make_index_list<sizeof...(args_type)>::type());
+				}
+			}
+		}
+
+		template<class element_type, std::size_t... indices>
+		static void call_element(const connection_type& conn, element_type&& element, _index_list<indices...>) {
+			conn.m_invoke(conn, std::get<indices>(element)...);
+		}
+
+		static void call(std::false_type, const connection_type& conn, typename _arg<args_type>::type... args) {
+			conn.m_invoke(conn, args...);
+		}
+
+		static void call(_detached_walk, const connection_type& conn, typename _arg<args_type>::type... args)
+		{
+			if (!conn.m_link) {
+				conn.m_invoke(conn, args...);
+			}
+			else {
+				call(std::true_type(), conn, args...);
+			}
+		}
+
+		static void call(std::true_type, const connection_type& conn, typename _arg<args_type>::type... args)
+		{
+			_call_frame frame(&conn.m_link->m_calls);
+
+			if (conn.m_link->connected()) {
+				conn.m_invoke(conn, args...);
+			}
+		}
+
+		static void call_move(std::false_type, const connection_type& conn, typename _arg<args_type>::rvalue... args) {
+			conn.m_invoke_move(conn, std::forward<typename _arg<args_type>::rvalue>(args)...);
+		}
+
+		static void call_move(_detached_walk, const connection_type& conn, typename _arg<args_type>::rvalue... args)
+		{
+			if (!conn.m_link) {
+				conn.m_invoke_move(conn, std::forward<typename _arg<args_type>::rvalue>(args)...);
+			}
+			else {
+				call_move(std::true_type(), conn, std::forward<typename _arg<args_type>::rvalue>(args)...);
+			}
+		}
+
+		static void call_move(std::true_type, const connection_type& conn, typename _arg<args_type>::rvalue... args)
+		{
+			_call_frame frame(&conn.m_link->m_calls);
+
+			if (conn.m_link->connected()) {
+				conn.m_invoke_move(conn, std::forward<typename _arg<args_type>::rvalue>(args)...);
+			}
+		}
+
+		template<class checked, class list_type>
+		static void invoke_move(checked, const list_type& list, std::size_t count, typename _arg<args_type>::rvalue... args)
+		{
+			std::size_t last = count;
+
+			while (last > 0 && !list[last - 1].m_invoke) {
+				--last;
+			}
+
+			if (last == 0) {
+				return;
+			}
+
+			invoke(checked(), list, last - 1, args...);
+
+			// An earlier slot may have disconnected it.
+			const connection_type& conn = list[last - 1];
+
+			if (conn.m_invoke) {
+				call_move(checked(), conn, std::forward<typename _arg<args_type>::rvalue>(args)...);
+			}
+		}
+
+		connection connect(basic_has_slots<lock_policy>* pdest, connection_type conn, _slot_target<lock_policy>* target = nullptr, priority order = priority())
+		{
+			conn.m_priority = order.m_value;
+			_ordered_guard<lock_policy> guard(this, pdest);
+			connection handle = base_type::insert(conn, pdest, target);
+			base_type::publish();
+			return handle;
+		}
+	};
+
+	template<typename... args_type>
+	using signals = basic_signals<SIGSLOT_DEFAULT_MT_POLICY, args_type...>;
+
+	// Combiners fold the values returned by the slots of a basic_combining_signals as
+	// each slot returns, so no container of results is ever built. A combiner is copied
+	// afresh for every emission; operator() takes one slot's result and returns false to
+	// skip the remaining slots, and result() is what the emission returns. Any class with
+	// that shape will do.
+	template<class R>
+	struct last_value
+	{
+		typedef R result_type;
+		R m_value;
+
+		last_value()
+			: m_value()
+		{}
+
+		bool operator()(R value)
+		{
+			m_value = std::move(value);
+			return true;
+		}
+
+		R result() const { return m_value; }
+	};
+
+	template<class R>
+	struct first_value
+	{
+		typedef R result_type;
+		R m_value;
+
+		first_value()
+			: m_value()
+		{}
+
+		bool operator()(R value)
+		{
+			m_value = std::move(value);
+			return false;
+		}
+
+		R result() const { return m_value; }
+	};
+
+	template<class R>
+	struct sum_of
+	{
+		typedef R result_type;
+		R m_total;
+
+		sum_of()
+			: m_total()
+		{}
+
+		bool operator()(const R& value)
+		{
+			m_total += value;
+			return true;
+		}
+
+		R result() const { return m_total; }
+	};
+
+	// R() when no slot ran.
+	template<class R>
+	struct min_of
+	{
+		typedef R result_type;
+		R m_value;
+		bool m_seen;
+
+		min_of()
+			: m_value(), m_seen(false)
+		{}
+
+		bool operator()(R value)
+		{
+			if (!m_seen || value < m_value) {
+				m_value = std::move(value);
+			}
+
+			m_seen = true;
+			return true;
+		}
+
+		R result() const { return m_value; }
+	};
+
+	template<class R>
+	struct max_of
+	{
+		typedef R result_type;
+		R m_value;
+		bool m_seen;
+
+		max_of()
+			: m_value(), m_seen(false)
+		{}
+
+		bool operator()(R value)
+		{
+			if (!m_seen || m_value < value) {
+				m_value = std::move(value);
+			}
+
+			m_seen = true;
+			return true;
+		}
+
+		R result() const { return m_value; }
+	};
+
+	// Stops at the first false; true when no slot ran.
+	struct all_true
+	{
+		typedef bool result_type;
+		bool m_value;
+
+		all_true()
+			: m_value(true)
+		{}
+
+		bool operator()(bool value) {
+			return m_value = value;
+		}
+
+		bool result() const { return m_value; }
+	};
+
+	// Stops at the first true, such as a veto; false when no slot ran.
+	struct any_true
+	{
+		typedef bool result_type;
+		bool m_value;
+
+		any_true()
+			: m_value(false)
+		{}
+
+		bool operator()(bool value) {
+			return !(m_value = value);
+		}
+
+		bool result() const { return m_value; }
+	};
+
+	// Folds with function(accumulated, value), starting from the initial value given to
+	// the signal: basic_combining_signals<P, int(int), reducer<int, std::multiplies<int> > >
+	// sig(reducer<int, std::multiplies<int> >(1)).
+	template<class R, class function>
+	struct reducer
+	{
+		typedef R result_type;
+		R m_value;
+		function m_function;
+
+		explicit reducer(R initial = R(), function f = function())
+			: m_value(std::move(initial)), m_function(f)
+		{}
+
+		template<class value_type>
+		bool operator()(value_type&& value)
+		{
+			m_value = m_function(std::move(m_value), std::forward<value_type>(value));
+			return true;
+		}
+
+		R result() const { return m_value; }
+	};
+
+	// An emission's combiner, passed to every slot thunk ahead of the signal's arguments.
+	template<class combiner>
+	struct _fold
+	{
+		combiner m_combiner;
+		bool m_stopped;
+
+		explicit _fold(const combiner& c)
+			: m_combiner(c), m_stopped(false)
+		{}
+
+		template<class value_type>
+		void add(value_type&& value) {
+			m_stopped = !m_combiner(std::forward<value_type>(value));
+		}
+	};
+
+	template<class dest_type, class mt_policy, class fold_type, class signal_args, class memfun_type>
+	struct _folding_thunks;
+
+	template<class dest_type, class mt_policy, class fold_type, class... args_type, class slot_result, class... slot_args>
+	struct _folding_thunks<dest_type, mt_policy, fold_type, _type_list<args_type...>, slot_result (dest_type::*)(slot_args...)>
+	{
+		typedef _connection<mt_policy, fold_type&, args_type...> connection_type;
+		typedef slot_result (dest_type::* memfun_type)(slot_args...);
+
+		static_assert(sizeof...(args_type) == sizeof...(slot_args), "slot must take one parameter per signal argument");
+
+		static void invoke(const connection_type& conn, fold_type& fold, typename _arg<args_type>::type... args)
+		{
+			memfun_type pmemfun;
+			std::memcpy(&pmemfun, conn.m_memfun, sizeof(pmemfun));
+			fold.add((static_cast<dest_type*>(conn.m_object)->*pmemfun)(_slot_param<slot_args>::pass(args)...));
+		}
+
+		static connection_type make(dest_type* pobject, memfun_type pmemfun)
+		{
+			static_assert(sizeof(memfun_type) <= sizeof(_generic_memfun), "member function pointer too large");
+
+			connection_type conn;
+			conn.m_invoke = &invoke;
+			conn.m_object = pobject;
+			std::memset(conn.m_memfun, 0, sizeof(conn.m_memfun));
+			std::memcpy(conn.m_memfun, &pmemfun, sizeof(pmemfun));
+			conn.m_invoke_move = nullptr;
+			conn.m_link = nullptr;
+			conn.m_slot = 0;
+			conn.m_priority = 0;
+			return conn;
+		}
+	};
+
+	// Wraps a callable so that its result goes to the fold; stored like any other callable,
+	// inline when it fits.
+	template<class functor, class fold_type>
+	struct _folding_callable
+	{
+		functor m_functor;
+
+		// The const overload exists only for callables that can be called const, which
+		// keeps those eligible for inline storage.
+		template<class... call_args>
+		auto operator()(fold_type& fold, call_args&&... args) const -> decltype(fold.add(std::declval<const functor&>()(args...)))
+		{
+			fold.add(m_functor(args...));
+		}
+
+		template<class... call_args>
+		void operator()(fold_type& fold, call_args&&... args) {
+			fold.add(m_functor(args...));
+		}
+	};
+
+	template<class signature>
+	struct _signature_result;
+
+	template<class R, class... args_type>
+	struct _signature_result<R(args_type...)>
+	{
+		typedef R type;
+	};
+
+	template<class mt_policy, class signature, class combiner = last_value<typename _signature_result<signature>::type> >
+	class basic_combining_signals;
+
+	// A signal whose slots return values, folded by combiner into what emit() returns:
+	// basic_combining_signals<P, bool(const order&), any_true>. It shares basic_signals'
+	// connection machinery, policies and priorities; only member function and callable
+	// slots can be connected, as a queued slot has no result to give back. A slot may
+	// return anything the combiner accepts.
+	template<class mt_policy, class R, class... args_type, class combiner>
+	class basic_combining_signals<mt_policy, R(args_type...), combiner> : public _signal_bases<mt_policy, _fold<combiner>&, args_type...>
+	{
+		typedef _fold<combiner> fold_type;
+		typedef _signal_bases<mt_policy, fold_type&, args_type...> base_type;
+		typedef typename base_type::lock_policy lock_policy;
+		typedef typename base_type::connection_type connection_type;
+
+		combiner m_combiner;
+
+	public:
+		typedef typename combiner::result_type result_type;
+
+		// Each emission starts from a copy of c.
+		explicit basic_combining_signals(const combiner& c = combiner())
+			: base_type(get_default_resource()), m_combiner(c)
+		{}
+
+		basic_combining_signals(const basic_combining_signals& s)
+			: base_type(s, get_default_resource()), m_combiner(s.m_combiner)
+		{
+			base_type::copy_connections(s);
+		}
+
+		basic_combining_signals(basic_combining_signals&& s) noexcept(!base_type::traits::snapshot_emit && std::is_nothrow_copy_constructible<combiner>::value)
+			: base_type(std::move(s)), m_combiner(s.m_combiner)
+		{
+			base_type::take_connections(s);
+		}
+
+		// See ~basic_signals().
+		~basic_combining_signals() {
+			base_type::disconnect_all();
+		}
+
+		basic_combining_signals& operator=(basic_combining_signals&& s)
+		{
+			base_type::operator=(std::move(s));
+			m_combiner = s.m_combiner;
+			return *this;
+		}
+
+		template<class desttype, class slot_result, class... slot_args>
+		connection connect(desttype* pclass, slot_result (desttype::* pmemfun)(slot_args...), priority order = priority())
+		{
+			typedef _folding_thunks<desttype, lock_policy, fold_type, _type_list<args_type...>, slot_result (desttype::*)(slot_args...)> thunks;
+			return connect(pclass, thunks::make(pclass, pmemfun), nullptr, order);
+		}
+
+		template<class functor>
+		connection connect(functor&& f, priority order = priority())
+		{
+			typedef _folding_callable<typename std::decay<functor>::type, fold_type> adapter_type;
+			typedef _callable_thunks<adapter_type, lock_policy, fold_type&, args_type...> thunks;
+			adapter_type adapter = { std::forward<functor>(f) };
+			connection_type conn;
+			_slot_target<lock_policy>* target = thunks::make(conn, std::move(adapter), base_type::target_resource());
+			return connect(nullptr, conn, target, order);
+		}
+
+		bool has_receivers() const {
+			return base_type::m_live.load(std::memory_order_relaxed) != 0;
+		}
+
+		// Calls the slots in priority order, each with the arguments by const reference,
+		// until the combiner asks to stop, and returns the combiner's result.
+		template<class... call_args>
+		result_type emit(call_args&&... args)
+		{
+			if (!has_receivers()) {
+				return combiner(m_combiner).result();
+			}
+
+			return emit_copy(std::forward<call_args>(args)...);
+		}
+
+		template<class... call_args>
+		result_type operator()(call_args&&... args) {
+			return emit(std::forward<call_args>(args)...);
+		}
+
+	private:
+		result_type emit_copy(typename _arg<args_type>::type... args)
+		{
+			fold_type fold(m_combiner);
+
+			if (base_type::traits::snapshot_emit)
+			{
+				_epoch_guard epoch;
+				const typename base_type::snapshot_type* snapshot = base_type::m_snapshot.load();
+
+				if (snapshot) {
+					invoke(std::true_type(), snapshot->m_slots, snapshot->m_slots.size(), fold, args...);
+				}
+			}
+			else if (base_type::traits::detached_emit)
+			{
+				typename base_type::detached_emit_scope scope(*this);
+				invoke(_detached_walk(), scope.m_slots, scope.m_slots.size(), fold, args...);
+			}
+			else
+			{
+				typename base_type::emit_lock lock(*this);
+				invoke(std::false_type(), base_type::m_connected_slots, base_type::m_connected_slots.size(), fold, args...);
+			}
+
+			return fold.m_combiner.result();
+		}
+
+		// As basic_signals::invoke(), stopping once the combiner has had enough.
+		template<class checked, class list_type>
+		static void invoke(checked, const list_type& list, std::size_t count, fold_type& fold, typename _arg<args_type>::type... args)
+		{
+			for (std::size_t i = 0; i < count && !fold.m_stopped; ++i)
+			{
+				const connection_type& conn = list[i];
+
+				if (conn.m_invoke) {
+					call(checked(), conn, fold, args...);
+				}
+			}
+		}
+
+		static void call(std::false_type, const connection_type& conn, fold_type& fold, typename _arg<args_type>::type... args) {
+			conn.m_invoke(conn, fold, args...);
+		}
+
+		static void call(std::true_type, const connection_type& conn, fold_type& fold, typename _arg<args_type>::type... args)
+		{
+			_call_frame frame(&conn.m_link->m_calls);
+
+			if (conn.m_link->connected()) {
+				conn.m_invoke(conn, fold, args...);
+			}
+		}
+
+		static void call(_detached_walk, const connection_type& conn, fold_type& fold, typename _arg<args_type>::type... args)
+		{
+			if (!conn.m_link) {
+				conn.m_invoke(conn, fold, args...);
+			}
+			else {
+				call(std::true_type(), conn, fold, args...);
+			}
+		}
+
+		connection connect(basic_has_slots<lock_policy>* pdest, connection_type conn, _slot_target<lock_policy>* target, priority order)
+		{
+			conn.m_priority = order.m_value;
+			_ordered_guard<lock_policy> guard(this, pdest);
+			connection handle = base_type::insert(conn, pdest, target);
+			base_type::publish();
+			return handle;
+		}
+	};
+
+	template<class signature, class combiner = last_value<typename _signature_result<signature>::type> >
+	using combining_signals = basic_combining_signals<SIGSLOT_DEFAULT_MT_POLICY, signature, combiner>;
+
+	// The record behind a basic_compact_signals once something connects to it. It holds
+	// the first connection itself; the second connect promotes it to a basic_signals,
+	// into which that connection moves under the handle it already had, and from then on
+	// the record only forwards. Like basic_signals, it calls its one slot with the lock
+	// held, or for copy_on_write inside an epoch, checking the link. Under a policy whose
+	// emissions walk a copy it holds no connection and forwards from the first connect.
+	template<class mt_policy, typename... args_type>
+	class _single_signal : public _signal_base<typename _policy_traits<mt_policy>::lock_policy>
+	{
+		typedef _policy_traits<mt_policy> traits;
+		typedef typename traits::lock_policy lock_policy;
+		typedef basic_signals<mt_policy, args_type...> signal_type;
+		typedef _connection<lock_policy, args_type...> connection_type;
+		typedef _connection_link<lock_policy> link_type;
+		typedef typename _signal_bases<mt_policy, args_type...>::emit_scope signal_scope;
+
+		// m_conn is written once, under the lock, before m_connected is first set, and is
+		// never written again: emitters may be reading it. Disconnecting clears m_connected
+		// and lets go of the link; a record that has held a connection never takes another,
+		// so its handle, connection(0, 0), is not reissued.
+		memory_resource* m_resource;
+		connection_type m_conn;
+		std::atomic<bool> m_connected;
+		std::atomic<signal_type*> m_promoted;
+		int m_emitting;
+		bool m_release; // the link waits for the outermost locked emission
+		signal_scope* m_held; // as does the list of a signal promoted during one
+
+		// What an emission through m_conn holds: an epoch for copy_on_write, otherwise the
+		// record's lock, shared where the policy lets emitters share it.
+		struct epoch_scope
+		{
+			_epoch_guard m_epoch;
+
+			explicit epoch_scope(_single_signal&)
+			{}
+		};
+
+		// A signal promoted during the emission is let go of after the record, which is
+		// locked before it (see _ordered_guard).
+		struct exclusive_scope
+		{
+			_single_signal& m_record;
+
+			explicit exclusive_scope(_single_signal& record)
+				: m_record(record)
+			{
+				m_record.lock();
+				++m_record.m_emitting;
+			}
+
+			~exclusive_scope()
+			{
+				signal_scope* held = m_record.end_emission();
+				m_record.unlock();
+
+				if (held)
+				{
+					StaticGuard<lock_policy> guard(m_record.promoted());
+					delete held;
+				}
+			}
+		};
+
+		struct shared_scope
+		{
+			SharedGuard<lock_policy> m_guard;
+
+			explicit shared_scope(_single_signal& record)
+				: m_guard(&record)
+			{}
+		};
+
+		typedef typename std::conditional<traits::snapshot_emit, epoch_scope,
+			typename std::conditional<traits::shared_emit, shared_scope, exclusive_scope>::type>::type emit_scope;
+
+	public:
+		explicit _single_signal(memory_resource* resource)
+			: m_resource(resource), m_conn(), m_connected(false), m_promoted(nullptr), m_emitting(0), m_release(false), m_held(nullptr)
+		{}
+
+		// Copies like basic_signals does, so handles are interchangeable. The record is read
+		// under its lock; one promoted meanwhile is copied as the signal it grew into.
+		_single_signal(const _single_signal& s)
+			: _signal_base<lock_policy>(s), m_resource(s.m_resource), m_conn(), m_connected(false), m_promoted(nullptr), m_emitting(0), m_release(false), m_held(nullptr)
+		{
+			signal_type* psignal = s.promoted();
+
+			if (!psignal)
+			{
+				_ordered_guard<lock_policy> guard(const_cast<_single_signal*>(&s), this, [&s](_lock_set<lock_policy>& objects) { s.add_receiver(objects); });
+				psignal = s.promoted();
+
+				if (!psignal)
+				{
+					copy_record(s);
+					return;
+				}
+			}
+
+			m_promoted.store(new signal_type(*psignal, m_resource), std::memory_order_relaxed);
+		}
+
+		~_single_signal()
+		{
+			if (signal_type* psignal = promoted())
+			{
+				delete psignal;
+				return;
+			}
+
+			_ordered_guard<lock_policy> guard(this, nullptr, [this](_lock_set<lock_policy>& objects) { add_receiver(objects); });
+
+			if (m_connected.load(std::memory_order_relaxed)) {
+				drop(true);
+			}
+		}
+
+		_single_signal& operator=(const _single_signal&) = delete;
+
+		template<class desttype, class... slot_args>
+		connection connect(desttype* pclass, void (desttype::* pmemfun)(slot_args...), priority order = priority())
+		{
+			if (!promoted())
+			{
+				_ordered_guard<lock_policy> guard(this, pclass);
+
+				if (can_hold()) {
+					return attach(pclass, _connection_thunks<desttype, lock_policy, _type_list<args_type...>, _type_list<slot_args...> >::make(pclass, pmemfun), nullptr, order);
+				}
+			}
+
+			return promote()->connect(pclass, pmemfun, order);
+		}
+
+		template<class functor>
+		connection connect(functor&& f, priority order = priority())
+		{
+			if (!promoted())
+			{
+				StaticGuard<lock_policy> guard(this);
+
+				if (can_hold())
+				{
+					typedef _callable_thunks<typename std::decay<functor>::type, lock_policy, args_type...> thunks;
+					connection_type conn;
+					_slot_target<lock_policy>* target = thunks::make(conn, std::forward<functor>(f), target_resource());
+					return attach(nullptr, conn, target, order);
+				}
+			}
+
+			return promote()->connect(std::forward<functor>(f), order);
+		}
+
+#if __cplusplus >= 201703L
+		template<auto pmemfun, class desttype>
+		connection connect(desttype* pclass, priority order = priority())
+		{
+			if (!promoted())
+			{
+				_ordered_guard<lock_policy> guard(this, pclass);
+
+				if (can_hold())
+				{
+					typedef _connection_thunks<desttype, lock_policy, _type_list<args_type...>, typename _memfun_args<decltype(pmemfun)>::type> thunks;
+					return attach(pclass, thunks::template make_static<pmemfun>(pclass), nullptr, order);
+				}
+			}
+
+			return promote()->template connect<pmemfun>(pclass, order);
+		}
+#endif
+
+		// Queued and conflated connections go straight to a basic_signals.
+		template<class... connect_args>
+		connection connect(connect_args&&... args) {
+			return promote()->connect(std::forward<connect_args>(args)...);
+		}
+
+		bool disconnect(connection conn)
+		{
+			if (!promoted())
+			{
+				_ordered_guard<lock_policy> guard(this, nullptr, [this](_lock_set<lock_policy>& objects) { add_receiver(objects); });
+
+				if (!promoted())
+				{
+					if (conn.index() != 0 || conn.generation() != 0 || !m_connected.load(std::memory_order_relaxed)) {
+						return false;
+					}
+
+					drop(true);
+					return true;
+				}
+			}
+
+			return promoted()->disconnect(conn);
+		}
+
+		void disconnect(basic_has_slots<lock_policy>* pclass)
+		{
+			if (!promoted())
+			{
+				_ordered_guard<lock_policy> guard(this, pclass);
+
+				if (!promoted())
+				{
+					if (m_connected.load(std::memory_order_relaxed) && m_conn.getdest() == pclass) {
+						drop(true);
+					}
+
+					return;
+				}
+			}
+
+			promoted()->disconnect(pclass);
+		}
+
+		void disconnect_all()
+		{
+			if (!promoted())
+			{
+				_ordered_guard<lock_policy> guard(this, nullptr, [this](_lock_set<lock_policy>& objects) { add_receiver(objects); });
+
+				if (!promoted())
+				{
+					if (m_connected.load(std::memory_order_relaxed)) {
+						drop(true);
+					}
+
+					return;
+				}
+			}
+
+			promoted()->disconnect_all();
+		}
+
+		bool connected(connection conn)
+		{
+			if (!promoted())
+			{
+				StaticGuard<lock_policy> guard(this);
+
+				if (!promoted()) {
+					return conn.index() == 0 && conn.generation() == 0 && m_connected.load(std::memory_order_relaxed);
+				}
+			}
+
+			return promoted()->connected(conn);
+		}
+
+		bool has_receivers() const
+		{
+			const signal_type* psignal = promoted();
+			return psignal ? psignal->has_receivers() : m_connected.load(std::memory_order_relaxed);
+		}
+
+		template<class... call_args>
+		void emit(call_args&&... args)
+		{
+			if (signal_type* psignal = promoted()) {
+				psignal->emit(std::forward<call_args>(args)...);
+			}
+			else if (m_connected.load(std::memory_order_relaxed)) {
+				emit_args(std::integral_constant<bool, _all_of<!std::is_lvalue_reference<call_args>::value...>::value>(),
+					std::forward<call_args>(args)...);
+			}
+		}
+
+		// Called by the receiver, with the receiver locked, while the record still holds
+		// the connection; promotion re-points the link at the new signal.
+		bool slot_disconnect(link_type*, bool wait)
+		{
+			StaticGuard<lock_policy> guard(this);
+			drop(false);
+
+			if (!wait || !traits::snapshot_emit) {
+				return false;
+			}
+
+			this->m_waiters.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+
+		// A second receiver, or one that moved, is the basic_signals' business. The record
+		// has not been promoted, or the link would name the new signal; that signal takes
+		// the connection before other threads can reach it, as its lock may not be waited
+		// for with the receivers' held.
+		void slot_duplicate(const link_type* plink, basic_has_slots<lock_policy>* pnewslot)
+		{
+			StaticGuard<lock_policy> guard(this);
+			signal_type* psignal = create();
+			psignal->duplicate_link(plink, pnewslot);
+			m_promoted.store(psignal, std::memory_order_release);
+		}
+
+		void slot_relocate(link_type* plink, basic_has_slots<lock_policy>* pnewslot)
+		{
+			StaticGuard<lock_policy> guard(this);
+			signal_type* psignal = create();
+			psignal->relocate_link(plink, pnewslot);
+			m_promoted.store(psignal, std::memory_order_release);
+		}
+
+	private:
+		signal_type* promoted() const {
+			return m_promoted.load(std::memory_order_acquire);
+		}
+
+		bool vacant() const {
+			return !m_conn.m_invoke;
+		}
+
+		// Under a detached_emit policy the record would have to hold its link back from
+		// disconnects the way basic_signals does, so there every connection goes to one.
+		bool can_hold() const {
+			return !traits::detached_emit && vacant();
+		}
+
+		// For an _ordered_guard; the link is only the record's to read until promotion.
+		void add_receiver(_lock_set<lock_policy>& objects) const
+		{
+			if (!promoted() && m_connected.load(std::memory_order_relaxed) && m_conn.getdest()) {
+				objects.add(m_conn.getdest());
+			}
+		}
+
+		// The helpers below expect the record, and the receiver if any, to be locked.
+		void copy_record(const _single_signal& s)
+		{
+			if (!s.m_connected.load(std::memory_order_relaxed))
+			{
+				// A spent handle stays spent.
+				m_conn.m_invoke = s.m_conn.m_invoke;
+				return;
+			}
+
+			basic_has_slots<lock_policy>* pdest = s.m_conn.getdest();
+			_slot_target<lock_policy>* target = s.m_conn.m_link ? s.m_conn.m_link->m_target : nullptr;
+			connection_type conn = s.m_conn;
+
+			if (target)
+			{
+				target = target->duplicate(pdest, target_resource());
+				conn.m_object = target;
+			}
+
+			attach(pdest, conn, target, priority(conn.m_priority));
+		}
+
+		connection attach(basic_has_slots<lock_policy>* pdest, connection_type conn, _slot_target<lock_policy>* target, priority order)
+		{
+			conn.m_priority = order.m_value;
+			conn.m_slot = 0;
+			conn.m_link = pdest || target || traits::snapshot_emit ? link(pdest, target) : nullptr;
+			m_conn = conn;
+			m_connected.store(true, std::memory_order_release);
+			return connection(0, 0);
+		}
+
+		// Allocated as the basic_signals that may adopt it would have, as are targets.
+		memory_resource* target_resource() const {
+			return traits::snapshot_emit ? _heap_resource() : m_resource;
+		}
+
+		link_type* link(basic_has_slots<lock_policy>* pdest, _slot_target<lock_policy>* target)
+		{
+			link_type* plink = traits::snapshot_emit ? new link_type() : new (m_resource->allocate(sizeof(link_type), alignof(link_type))) link_type();
+			plink->m_signal = this;
+			plink->m_dest = pdest;
+			plink->m_target = target;
+			plink->m_slot = 0;
+			plink->m_connected.store(true, std::memory_order_relaxed);
+			plink->m_calls.store(0, std::memory_order_relaxed);
+
+			if (pdest) {
+				pdest->signal_connect(plink);
+			}
+
+			return plink;
+		}
+
+		// A locked emission may still be in the slot, which may live in the target, so the
+		// link goes once the outermost one returns; copy_on_write retires it.
+		void drop(bool unlink)
+		{
+			m_connected.store(false, std::memory_order_seq_cst);
+			link_type* plink = m_conn.m_link;
+
+			if (!plink) {
+				return;
+			}
+
+			if (unlink && plink->m_dest) {
+				plink->m_dest->signal_disconnect(plink);
+			}
+
+			plink->m_connected.store(false, std::memory_order_seq_cst);
+
+			if (plink->m_target) {
+				plink->m_target->disconnect();
+			}
+
+			if (traits::snapshot_emit) {
+				_epoch_domain::instance().retire(plink, &destroy_link);
+			}
+			else if (m_emitting != 0) {
+				m_release = true;
+			}
+			else {
+				release_link();
+			}
+		}
+
+		void release_link()
+		{
+			link_type* plink = m_conn.m_link;
+
+			if (plink->m_target) {
+				plink->m_target->release();
+			}
+
+			m_resource->deallocate(plink, sizeof(link_type), alignof(link_type));
+		}
+
+		static void destroy_link(void* p)
+		{
+			link_type* plink = static_cast<link_type*>(p);
+
+			if (plink->m_target) {
+				plink->m_target->release();
+			}
+
+			delete plink;
+		}
+
+		// Emissions under way through the record hold the new signal's list in place, as
+		// they would had they started on it.
+		signal_type* promote()
+		{
+			if (signal_type* psignal = promoted()) {
+				return psignal;
+			}
+
+			_ordered_guard<lock_policy> guard(this, nullptr, [this](_lock_set<lock_policy>& objects) { add_receiver(objects); });
+
+			if (signal_type* psignal = promoted()) {
+				return psignal;
+			}
+
+			signal_type* psignal = create();
+			m_promoted.store(psignal, std::memory_order_release);
+			return psignal;
+		}
+
+		// The signal to promote to, not yet published. Expects the record locked.
+		signal_type* create()
+		{
+			signal_type* psignal = new signal_type(m_resource);
+
+			if (!vacant()) {
+				psignal->adopt(m_conn, m_connected.load(std::memory_order_relaxed));
+			}
+
+			if (m_emitting != 0) {
+				m_held = new signal_scope(*psignal);
+			}
+
+			return psignal;
+		}
+
+		// Returns the scope holding a promoted signal's list, once the outermost emission
+		// is done, for the caller to end with that signal locked.
+		signal_scope* end_emission()
+		{
+			if (--m_emitting != 0) {
+				return nullptr;
+			}
+
+			if (m_release)
+			{
+				m_release = false;
+				release_link();
+			}
+
+			signal_scope* held = m_held;
+			m_held = nullptr;
+			return held;
+		}
+
+		template<class... call_args>
+		void emit_args(std::false_type, call_args&&... args)
+		{
+			if (signal_type* psignal = call(std::forward<call_args>(args)...)) {
+				psignal->emit(std::forward<call_args>(args)...);
+			}
+		}
+
+		template<class... call_args>
+		void emit_args(std::true_type, call_args&&... args) {
+			emit_move(std::forward<call_args>(args)...);
+		}
+
+		void emit_move(typename _arg<args_type>::rvalue... args)
+		{
+			if (signal_type* psignal = call_move(std::forward<typename _arg<args_type>::rvalue>(args)...)) {
+				psignal->emit(std::forward<typename _arg<args_type>::rvalue>(args)...);
+			}
+		}
+
+		// copy_on_write calls are counted on the link, as basic_signals counts them.
+		std::atomic<std::uint32_t>* calls() const {
+			return traits::snapshot_emit ? &m_conn.m_link->m_calls : nullptr;
+		}
+
+		bool live() const {
+			return !traits::snapshot_emit || m_conn.m_link->connected();
+		}
+
+		// Each calls the slot unless the record was promoted first, and then returns the
+		// signal to emit through instead.
+		signal_type* call(typename _arg<args_type>::type... args)
+		{
+			emit_scope scope(*this);
+			signal_type* psignal = promoted();
+
+			if (!psignal && m_connected.load(std::memory_order_seq_cst))
+			{
+				_call_frame frame(calls());
+
+				if (live()) {
+					m_conn.m_invoke(m_conn, args...);
+				}
+			}
+
+			return psignal;
+		}
+
+		signal_type* call_move(typename _arg<args_type>::rvalue... args)
+		{
+			emit_scope scope(*this);
+			signal_type* psignal = promoted();
+
+			if (!psignal && m_connected.load(std::memory_order_seq_cst))
+			{
+				_call_frame frame(calls());
+
+				if (live()) {
+					m_conn.m_invoke_move(m_conn, std::forward<typename _arg<args_type>::rvalue>(args)...);
+				}
+			}
+
+			return psignal;
+		}
+	};
+
+	// A signal that costs one pointer until something connects to it, for objects that
+	// carry many signals most of which never get a receiver. The first connect allocates a
+	// record holding just that connection; a second one moves it into a basic_signals,
+	// where up to SIGSLOT_INLINE_CONNECTIONS of them are stored inline. Either stays until
+	// the compact signal goes away, so emitters never race its release. Emitting a signal
+	// that never had a connection is one load and a branch.
+	template<class mt_policy, typename... args_type>
+	class basic_compact_signals
+	{
+		typedef _single_signal<mt_policy, args_type...> record_type;
+
+		std::atomic<record_type*> m_record;
+
+	public:
+		basic_compact_signals()
+			: m_record(nullptr)
+		{}
+
+		basic_compact_signals(const basic_compact_signals& s)
+			: m_record(nullptr)
+		{
+			if (const record_type* precord = s.m_record.load(std::memory_order_acquire)) {
+				m_record.store(new record_type(*precord), std::memory_order_release);
+			}
+		}
+
+		basic_compact_signals(basic_compact_signals&& s) noexcept
+			: m_record(s.m_record.exchange(nullptr, std::memory_order_acq_rel))
+		{}
+
+		// Letting go of this signal's record may allocate, as basic_signals' move
+		// assignment does.
+		basic_compact_signals& operator=(basic_compact_signals&& s)
+		{
+			if (this != &s) {
+				delete m_record.exchange(s.m_record.exchange(nullptr, std::memory_order_acq_rel), std::memory_order_acq_rel);
+			}
+
+			return *this;
+		}
+
+		~basic_compact_signals() {
+			delete m_record.load(std::memory_order_relaxed);
+		}
+
+		// Any of basic_signals' connect() overloads.
+		template<class... connect_args>
+		connection connect(connect_args&&... args) {
+			return get().connect(std::forward<connect_args>(args)...);
+		}
+
+#if __cplusplus >= 201703L
+		template<auto pmemfun, class desttype>
+		connection connect(desttype* pclass, priority order = priority()) {
+			return get().template connect<pmemfun>(pclass, order);
+		}
+#endif
+
+		bool disconnect(connection conn)
+		{
+			record_type* precord = m_record.load(std::memory_order_acquire);
+			return precord && precord->disconnect(conn);
+		}
+
+		void disconnect(basic_has_slots<typename _policy_traits<mt_policy>::lock_policy>* pclass)
+		{
+			if (record_type* precord = m_record.load(std::memory_order_acquire)) {
+				precord->disconnect(pclass);
+			}
+		}
+
+		void disconnect_all()
+		{
+			if (record_type* precord = m_record.load(std::memory_order_acquire)) {
+				precord->disconnect_all();
+			}
+		}
+
+		bool connected(connection conn) const
+		{
+			record_type* precord = m_record.load(std::memory_order_acquire);
+			return precord && precord->connected(conn);
+		}
+
+		bool has_receivers() const
+		{
+			const record_type* precord = m_record.load(std::memory_order_acquire);
+			return precord && precord->has_receivers();
+		}
+
+		template<class factory>
+		void emit_lazy(factory f)
+		{
+			if (has_receivers()) {
+				emit_tuple(f(), typename _make_index_list<sizeof...(args_type)>::type());
+			}
+		}
+
+		template<class... call_args>
+		void emit(call_args&&... args)
+		{
+			if (record_type* precord = m_record.load(std::memory_order_acquire)) {
+				precord->emit(std::forward<call_args>(args)...);
+			}
+		}
+
+		template<class... call_args>
+		void operator()(call_args&&... args) {
+			emit(std::forward<call_args>(args)...);
+		}
+
+	private:
+		template<class tuple_type, std::size_t... indices>
+		void emit_tuple(tuple_type&& values, _index_list<indices...>) {
+			emit(std::get<indices>(std::move(values))...);
+		}
+
+		// Threads connecting at once race to install theirs; the losers free their copy.
+		record_type& get()
+		{
+			record_type* precord = m_record.load(std::memory_order_acquire);
+
+			if (precord) {
+				return *precord;
+			}
+
+			record_type* created = new record_type(get_default_resource());
+
+			if (m_record.compare_exchange_strong(precord, created, std::memory_order_acq_rel, std::memory_order_acquire)) {
+				return *created;
+			}
+
+			delete created;
+			return *precord;
+		}
+	};
+
+	template<typename... args_type>
+	using compact_signals = basic_compact_signals<SIGSLOT_DEFAULT_MT_POLICY, args_type...>;
+
+	// A member function named at compile time, for use as a static_signal slot:
+	// static_slot<decltype(&Chart::onTick), &Chart::onTick>.
+	template<class memfun_type, memfun_type pmemfun>
+	struct static_slot;
+
+	template<class desttype, class... slot_args, void (desttype::* pmemfun)(slot_args...)>
+	struct static_slot<void (desttype::*)(slot_args...), pmemfun>
+	{
+		typedef desttype target_type;
+
+		template<class... call_args>
+		static void call(desttype* ptarget, call_args&... args) {
+			(ptarget->*pmemfun)(args...);
+		}
+	};
+
+#if __cplusplus >= 201703L
+	// static_slot_of<&Chart::onTick>
+	template<auto pmemfun>
+	using static_slot_of = static_slot<decltype(pmemfun), pmemfun>;
+#endif
+
+	// Any other slot type is a function object, called through operator().
+	template<class slot_type>
+	struct _static_slot_traits
+	{
+		typedef slot_type target_type;
+
+		template<class... call_args>
+		static void call(slot_type* ptarget, call_args&... args) {
+			(*ptarget)(args...);
+		}
+	};
+
+	template<class memfun_type, memfun_type pmemfun>
+	struct _static_slot_traits<static_slot<memfun_type, pmemfun> > : public static_slot<memfun_type, pmemfun>
+	{};
+
+	// A signal whose slots are fixed at compile time, for wiring that is set up once and
+	// never changes. It holds one pointer per slot and emission is a sequence of direct
+	// calls the compiler can inline: no connection list, no lock, no indirection, no
+	// allocation. The targets are plain objects, not has_slots receivers, so nothing is
+	// disconnected for them: they must outlive the signal, or be unset first. An unset
+	// (null) target is skipped.
+	//
+	//	static_signal<static_slot<decltype(&Chart::onTick), &Chart::onTick>, Logger> ticks(&chart, &logger);
+	//	ticks(symbol, price);
+	template<class... slots>
+	class static_signal
+	{
+		typedef std::tuple<typename _static_slot_traits<slots>::target_type*...> targets_type;
+
+		targets_type m_targets;
+
+	public:
+		static_signal()
+			: m_targets()
+		{}
+
+		explicit static_signal(typename _static_slot_traits<slots>::target_type*... targets)
+			: m_targets(targets...)
+		{}
+
+		// Rebinds the index'th slot; null unsets it.
+		template<std::size_t index>
+		void connect(typename std::tuple_element<index, targets_type>::type ptarget) {
+			std::get<index>(m_targets) = ptarget;
+		}
+
+		template<std::size_t index>
+		void disconnect() {
+			std::get<index>(m_targets) = nullptr;
+		}
+
+		// Calls the slots in declaration order, each with the arguments as lvalues.
+		template<class... call_args>
+		void emit(call_args&&... args) {
+			emit_all(typename _make_index_list<sizeof...(slots)>::type(), args...);
+		}
+
+		template<class... call_args>
+		void operator()(call_args&&... args) {
+			emit_all(typename _make_index_list<sizeof...(slots)>::type(), args...);
+		}
+
+	private:
+		template<std::size_t... indices, class... call_args>
+		void emit_all(_index_list<indices...>, call_args&... args)
+		{
+			// A braced list is evaluated left to right.
+			int order[] = { 0, (call<indices>(args...), 0)... };
+			(void)order;
+		}
+
+		template<std::size_t index, class... call_args>
+		void call(call_args&... args)
+		{
+			typedef typename std::tuple_element<index, std::tuple<slots...> >::type slot_type;
+
+			if (std::get<index>(m_targets)) {
+				_static_slot_traits<slot_type>::call(std::get<index>(m_targets), args...);
+			}
+		}
+	};
+
+}
+#endif // SIGSLOT_HPP
@@ -0,0 +1,820 @@
+// sigslot_bench.cpp : microbenchmarks for sigslot.hpp
+//
+// Usage: sigslot_bench [--json] [--quick]
+//
+// Prints one row per measurement, CSV unless --json is given. --quick shortens every
+// measurement, for smoke runs. ns_per_op is wall time per emit, per connect/disconnect
+// pair, or per receiver destroyed, depending on the benchmark.
+//
+//****************************************************************************
+
+#include "sigslot.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace sigslot;
+
+namespace
+{
+	typedef std::chrono::steady_clock clock_type;
+
+	struct Result
+	{
+		std::string m_benchmark;
+		std::string m_variant;
+		std::size_t m_param;
+		unsigned m_threads;
+		std::uint64_t m_iterations;
+		double m_ns_per_op;
+	};
+
+	std::vector<Result> g_results;
+	double g_min_seconds = 0.05;
+	std::uint64_t g_sink = 0;
+
+	void report(const char* benchmark, const std::string& variant, std::size_t param, unsigned threads,
+		std::uint64_t iterations, double seconds)
+	{
+		Result result = { benchmark, variant, param, threads, iterations, seconds * 1e9 / static_cast<double>(iterations) };
+		g_results.push_back(result);
+	}
+
+	// Runs op(n) with growing n until one run lasts g_min_seconds; returns that run's time.
+	template<class operation>
+	double measure(operation op, std::uint64_t& iterations)
+	{
+		iterations = 1;
+
+		for (;;)
+		{
+			clock_type::time_point start = clock_type::now();
+			op(iterations);
+			double seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+
+			if (seconds >= g_min_seconds || iterations >= (std::uint64_t(1) << 40)) {
+				return seconds;
+			}
+
+			iterations *= seconds > 0 ? std::max<std::uint64_t>(2, static_cast<std::uint64_t>(g_min_seconds / seconds)) : 16;
+		}
+	}
+
+	template<class mt_policy>
+	struct Sink : public basic_has_slots<mt_policy>
+	{
+		std::uint64_t m_sum = 0;
+
+		void onInt(int value) {
+			m_sum += static_cast<std::uint64_t>(value);
+		}
+
+		void onStringRef(const std::string& value) {
+			m_sum += value.size();
+		}
+
+		void onStringValue(std::string value) {
+			m_sum += value.size();
+		}
+	};
+
+	template<class mt_policy>
+	struct AtomicSink : public basic_has_slots<mt_policy>
+	{
+		std::atomic<std::uint64_t> m_sum{0};
+
+		void onInt(int value) {
+			m_sum.fetch_add(static_cast<std::uint64_t>(value), std::memory_order_relaxed);
+		}
+	};
+
+	// Tallies into the calling thread's own counter, so concurrent emitters share nothing
+	// through the slot and only what the signal itself writes shows.
+	template<class mt_policy>
+	struct LocalSink : public basic_has_slots<mt_policy>
+	{
+		static std::uint64_t& tally()
+		{
+			static thread_local std::uint64_t t_sum = 0;
+			return t_sum;
+		}
+
+		void onInt(int value) {
+			tally() += static_cast<std::uint64_t>(value);
+		}
+	};
+
+	const std::size_t g_fanouts[] = { 0, 1, 4, 64, 4096 };
+
+	template<class mt_policy>
+	void bench_emit_fanout(const char* variant)
+	{
+		typedef typename _policy_traits<mt_policy>::lock_policy lock_policy;
+
+		for (std::size_t fanout : g_fanouts)
+		{
+			basic_signals<mt_policy, int> sig;
+			std::vector<Sink<lock_policy> > sinks(fanout);
+
+			for (std::size_t i = 0; i < fanout; ++i) {
+				sig.connect(&sinks[i], &Sink<lock_policy>::onInt);
+			}
+
+			std::uint64_t iterations;
+			double seconds = measure([&](std::uint64_t n) {
+				for (std::uint64_t i = 0; i < n; ++i) {
+					sig(1);
+				}
+			}, iterations);
+
+			report("emit_fanout", variant, fanout, 1, iterations, seconds);
+
+			for (std::size_t i = 0; i < fanout; ++i) {
+				g_sink += sinks[i].m_sum;
+			}
+		}
+	}
+
+	// Lambdas connected directly, stored inline in the connection.
+	void bench_emit_fanout_lambda()
+	{
+		for (std::size_t fanout : g_fanouts)
+		{
+			basic_signals<single_threaded, int> sig;
+			std::vector<Sink<single_threaded> > sinks(fanout);
+
+			for (std::size_t i = 0; i < fanout; ++i)
+			{
+				Sink<single_threaded>* sink = &sinks[i];
+				sig.connect([sink](int value) { sink->onInt(value); });
+			}
+
+			std::uint64_t iterations;
+			double seconds = measure([&](std::uint64_t n) {
+				for (std::uint64_t i = 0; i < n; ++i) {
+					sig(1);
+				}
+			}, iterations);
+
+			report("emit_fanout", "lambda", fanout, 1, iterations, seconds);
+
+			for (std::size_t i = 0; i < fanout; ++i) {
+				g_sink += sinks[i].m_sum;
+			}
+		}
+	}
+
+	// The baseline a hand-rolled observer list would give.
+	void bench_emit_fanout_function()
+	{
+		for (std::size_t fanout : g_fanouts)
+		{
+			std::vector<Sink<single_threaded> > sinks(fanout);
+			std::vector<std::function<void(int)> > slots;
+
+			for (std::size_t i = 0; i < fanout; ++i)
+			{
+				Sink<single_threaded>* sink = &sinks[i];
+				slots.push_back([sink](int value) { sink->onInt(value); });
+			}
+
+			std::uint64_t iterations;
+			double seconds = measure([&](std::uint64_t n) {
+				for (std::uint64_t i = 0; i < n; ++i)
+				{
+					for (std::size_t s = 0; s < slots.size(); ++s) {
+						slots[s](1);
+					}
+				}
+			}, iterations);
+
+			report("emit_fanout", "std_function", fanout, 1, iterations, seconds);
+
+			for (std::size_t i = 0; i < fanout; ++i) {
+				g_sink += sinks[i].m_sum;
+			}
+		}
+	}
+
+	void bench_emit_args()
+	{
+		typedef Sink<single_threaded> sink_type;
+		const std::size_t fanouts[] = { 1, 4, 64 };
+		const std::string text(64, 'x');
+
+		for (std::size_t fanout : fanouts)
+		{
+			std::vector<sink_type> sinks(fanout);
+			basic_signals<single_threaded, int> ints;
+			basic_signals<single_threaded, std::string> refs;
+			basic_signals<single_threaded, std::string> values;
+
+			for (std::size_t i = 0; i < fanout; ++i)
+			{
+				ints.connect(&sinks[i], &sink_type::onInt);
+				refs.connect(&sinks[i], &sink_type::onStringRef);
+				values.connect(&sinks[i], &sink_type::onStringValue);
+			}
+
+			std::uint64_t iterations;
+			double seconds = measure([&](std::uint64_t n) {
+				for (std::uint64_t i = 0; i < n; ++i) {
+					ints(1);
+				}
+			}, iterations);
+			report("emit_args", "int", fanout, 1, iterations, seconds);
+
+			seconds = measure([&](std::uint64_t n) {
+				for (std::uint64_t i = 0; i < n; ++i) {
+					refs(text);
+				}
+			}, iterations);
+			report("emit_args", "string_const_ref_slot", fanout, 1, iterations, seconds);
+
+			seconds = measure([&](std::uint64_t n) {
+				for (std::uint64_t i = 0; i < n; ++i) {
+					values(text);
+				}
+			}, iterations);
+			report("emit_args", "string_by_value_slot", fanout, 1, iterations, seconds);
+
+			seconds = measure([&](std::uint64_t n) {
+				for (std::uint64_t i = 0; i < n; ++i) {
+					values(std::string(text));
+				}
+			}, iterations);
+			report("emit_args", "string_by_value_slot_rvalue", fanout, 1, iterations, seconds);
+
+			for (std::size_t i = 0; i < fanout; ++i) {
+				g_sink += sinks[i].m_sum;
+			}
+		}
+	}
+
+	// One connect plus one disconnect per op, against a signal that already has fanout
+	// other connections.
+	void bench_churn()
+	{
+		typedef Sink<single_threaded> sink_type;
+		const std::size_t fanouts[] = { 0, 64, 4096 };
+
+		for (std::size_t fanout : fanouts)
+		{
+			basic_signals<single_threaded, int> sig;
+			std::vector<sink_type> sinks(fanout);
+			sink_type churn;
+
+			for (std::size_t i = 0; i < fanout; ++i) {
+				sig.connect(&sinks[i], &sink_type::onInt);
+			}
+
+			std::uint64_t iterations;
+			double seconds = measure([&](std::uint64_t n) {
+				for (std::uint64_t i = 0; i < n; ++i) {
+					sig.disconnect(sig.connect(&churn, &sink_type::onInt));
+				}
+			}, iterations);
+			report("churn", "handle", fanout, 1, iterations, seconds);
+
+			seconds = measure([&](std::uint64_t n) {
+				for (std::uint64_t i = 0; i < n; ++i)
+				{
+					sig.connect(&churn, &sink_type::onInt);
+					sig.disconnect(&churn);
+				}
+			}, iterations);
+			report("churn", "receiver", fanout, 1, iterations, seconds);
+
+			// Inserted ahead of every other connection, shifting them.
+			seconds = measure([&](std::uint64_t n) {
+				for (std::uint64_t i = 0; i < n; ++i) {
+					sig.disconnect(sig.connect(&churn, &sink_type::onInt, priority(1)));
+				}
+			}, iterations);
+			report("churn", "handle_priority", fanout, 1, iterations, seconds);
+		}
+	}
+
+	// Destroys receivers that each listen to 16 signals with fanout other receivers.
+	void bench_teardown()
+	{
+		typedef Sink<single_threaded> sink_type;
+		const std::size_t fanouts[] = { 1, 64, 4096 };
+		const std::size_t signal_count = 16;
+		const std::size_t batch = 256;
+
+		for (std::size_t fanout : fanouts)
+		{
+			std::vector<basic_signals<single_threaded, int> > sigs(signal_count);
+			std::vector<sink_type> others(fanout);
+
+			for (std::size_t s = 0; s < signal_count; ++s)
+			{
+				for (std::size_t i = 0; i < fanout; ++i) {
+					sigs[s].connect(&others[i], &sink_type::onInt);
+				}
+			}
+
+			double seconds = 0;
+			std::uint64_t destroyed = 0;
+
+			while (seconds < g_min_seconds)
+			{
+				std::unique_ptr<std::vector<sink_type> > doomed(new std::vector<sink_type>(batch));
+
+				for (std::size_t r = 0; r < batch; ++r)
+				{
+					for (std::size_t s = 0; s < signal_count; ++s) {
+						sigs[s].connect(&(*doomed)[r], &sink_type::onInt);
+					}
+				}
+
+				clock_type::time_point start = clock_type::now();
+				doomed.reset();
+				seconds += std::chrono::duration<double>(clock_type::now() - start).count();
+				destroyed += batch;
+			}
+
+			report("teardown", "16_signals", fanout, 1, destroyed, seconds);
+		}
+	}
+
+	// Relocating a receiver that listens to 16 signals: moving it there and back, against
+	// copying it and destroying the copy.
+	void bench_relocate()
+	{
+		typedef Sink<single_threaded> sink_type;
+		const std::size_t signal_count = 16;
+		std::vector<basic_signals<single_threaded, int> > sigs(signal_count);
+		sink_type sink;
+
+		for (std::size_t s = 0; s < signal_count; ++s) {
+			sigs[s].connect(&sink, &sink_type::onInt);
+		}
+
+		std::uint64_t iterations;
+		double seconds = measure([&](std::uint64_t n) {
+			for (std::uint64_t i = 0; i < n; ++i)
+			{
+				sink_type moved(std::move(sink));
+				sink = std::move(moved);
+			}
+		}, iterations);
+		report("relocate", "move_and_back", signal_count, 1, iterations, seconds);
+
+		seconds = measure([&](std::uint64_t n) {
+			for (std::uint64_t i = 0; i < n; ++i) {
+				sink_type copy(sink);
+			}
+		}, iterations);
+		report("relocate", "copy", signal_count, 1, iterations, seconds);
+
+		for (std::size_t s = 0; s < signal_count; ++s) {
+			sigs[s](1);
+		}
+
+		g_sink += sink.m_sum;
+	}
+
+	template<class mt_policy>
+	void bench_threads(const char* variant)
+	{
+		typedef AtomicSink<typename _policy_traits<mt_policy>::lock_policy> sink_type;
+		const unsigned thread_counts[] = { 1, 2, 4 };
+
+		for (unsigned threads : thread_counts)
+		{
+			basic_signals<mt_policy, int> sig;
+			std::vector<sink_type> sinks(4);
+
+			for (std::size_t i = 0; i < sinks.size(); ++i) {
+				sig.connect(&sinks[i], &sink_type::onInt);
+			}
+
+			std::uint64_t iterations;
+			double seconds = measure([&](std::uint64_t n) {
+				std::vector<std::thread> workers;
+
+				for (unsigned t = 0; t < threads; ++t)
+				{
+					workers.emplace_back([&sig, n, threads] {
+						for (std::uint64_t i = 0; i < n / threads; ++i) {
+							sig(1);
+						}
+					});
+				}
+
+				for (std::size_t t = 0; t < workers.size(); ++t) {
+					workers[t].join();
+				}
+			}, iterations);
+
+			report("emit_threads", variant, sinks.size(), threads, iterations / threads * threads, seconds);
+		}
+	}
+
+	// Up to 16 threads emitting one signal into slots that write only thread-local state:
+	// copy_on_write emission should write no shared cache line and scale with the cores.
+	template<class mt_policy>
+	void bench_threads_scaling(const char* variant)
+	{
+		typedef LocalSink<typename _policy_traits<mt_policy>::lock_policy> sink_type;
+		const unsigned thread_counts[] = { 1, 2, 4, 8, 16 };
+
+		for (unsigned threads : thread_counts)
+		{
+			basic_signals<mt_policy, int> sig;
+			std::vector<sink_type> sinks(4);
+			std::atomic<std::uint64_t> total(0);
+
+			for (std::size_t i = 0; i < sinks.size(); ++i) {
+				sig.connect(&sinks[i], &sink_type::onInt);
+			}
+
+			std::uint64_t iterations;
+			double seconds = measure([&](std::uint64_t n) {
+				std::vector<std::thread> workers;
+
+				for (unsigned t = 0; t < threads; ++t)
+				{
+					workers.emplace_back([&sig, &total, n, threads] {
+						for (std::uint64_t i = 0; i < n / threads; ++i) {
+							sig(1);
+						}
+						total += sink_type::tally();
+						sink_type::tally() = 0;
+					});
+				}
+
+				for (std::size_t t = 0; t < workers.size(); ++t) {
+					workers[t].join();
+				}
+			}, iterations);
+
+			report("emit_threads_private", variant, sinks.size(), threads, iterations / threads * threads, seconds);
+			g_sink += total;
+		}
+	}
+
+	// The compact signal while unconnected, with a single receiver held in its record,
+	// and promoted to a basic_signals by a second; the regular signals' emit_fanout rows
+	// sit alongside.
+	void bench_emit_compact()
+	{
+		typedef Sink<multi_threaded_global> sink_type;
+		const std::size_t fanouts[] = { 0, 1, 2 };
+
+		for (std::size_t fanout : fanouts)
+		{
+			basic_compact_signals<multi_threaded_global, int> sig;
+			sink_type sink;
+
+			for (std::size_t i = 0; i < fanout; ++i) {
+				sig.connect(&sink, &sink_type::onInt);
+			}
+
+			std::uint64_t iterations;
+			double seconds = measure([&](std::uint64_t n) {
+				for (std::uint64_t i = 0; i < n; ++i) {
+					sig(1);
+				}
+			}, iterations);
+			report("emit_fanout", "compact", fanout, 1, iterations, seconds);
+			g_sink += sink.m_sum;
+		}
+	}
+
+	// A diagnostic string built per emission, eagerly and through emit_lazy().
+	void bench_emit_lazy()
+	{
+		typedef Sink<single_threaded> sink_type;
+		const std::size_t fanouts[] = { 0, 1 };
+
+		for (std::size_t fanout : fanouts)
+		{
+			basic_signals<single_threaded, std::string> sig;
+			sink_type sink;
+
+			if (fanout) {
+				sig.connect(&sink, &sink_type::onStringValue);
+			}
+
+			std::uint64_t iterations;
+			double seconds = measure([&](std::uint64_t n) {
+				for (std::uint64_t i = 0; i < n; ++i) {
+					sig(std::string("order ") + std::to_string(i) + " rejected: price outside the allowed band");
+				}
+			}, iterations);
+			report("emit_lazy", "eager", fanout, 1, iterations, seconds);
+
+			seconds = measure([&](std::uint64_t n) {
+				for (std::uint64_t i = 0; i < n; ++i) {
+					sig.emit_lazy([i] { return std::make_tuple(std::string("order ") + std::to_string(i) + " rejected: price outside the allowed band"); });
+				}
+			}, iterations);
+			report("emit_lazy", "lazy", fanout, 1, iterations, seconds);
+			g_sink += sink.m_sum;
+		}
+	}
+
+	// A pre-trade veto over 64 checks: any_true stops at the first objection, against
+	// collecting every answer into a vector and scanning it.
+	void bench_emit_veto()
+	{
+		const std::size_t fanout = 64;
+		const std::size_t vetoes[] = { 0, 8 };
+		std::vector<int> limits(fanout, 1000000);
+
+		for (std::size_t veto : vetoes)
+		{
+			if (veto) {
+				limits[veto - 1] = 0;
+			}
+
+			basic_combining_signals<single_threaded, bool(int), any_true> sig;
+			basic_signals<single_threaded, int, std::vector<bool>&> collect;
+
+			for (std::size_t i = 0; i < fanout; ++i)
+			{
+				const int* limit = &limits[i];
+				sig.connect([limit](int quantity) { return quantity > *limit; });
+				collect.connect([limit](int quantity, std::vector<bool>& answers) { answers.push_back(quantity > *limit); });
+			}
+
+			const char* variant = veto ? "veto_at_8" : "no_veto";
+			std::uint64_t iterations;
+			double seconds = measure([&](std::uint64_t n) {
+				for (std::uint64_t i = 0; i < n; ++i) {
+					g_sink += sig(static_cast<int>(i & 0xff));
+				}
+			}, iterations);
+			report("emit_veto_any_true", variant, fanout, 1, iterations, seconds);
+
+			std::vector<bool> answers;
+			seconds = measure([&](std::uint64_t n) {
+				for (std::uint64_t i = 0; i < n; ++i)
+				{
+					answers.clear();
+					collect(static_cast<int>(i & 0xff), answers);
+					g_sink += std::find(answers.begin(), answers.end(), true) != answers.end();
+				}
+			}, iterations);
+			report("emit_veto_collect", variant, fanout, 1, iterations, seconds);
+		}
+	}
+
+	// Four fixed receivers through a dynamic signal and through a static_signal.
+	void bench_emit_static()
+	{
+		typedef Sink<single_threaded> sink_type;
+		typedef static_slot<decltype(&sink_type::onInt), &sink_type::onInt> slot_type;
+		sink_type sinks[4];
+
+		basic_signals<single_threaded, int> dynamic;
+		for (std::size_t i = 0; i < 4; ++i) {
+			dynamic.connect(&sinks[i], &sink_type::onInt);
+		}
+
+		static_signal<slot_type, slot_type, slot_type, slot_type> fixed(&sinks[0], &sinks[1], &sinks[2], &sinks[3]);
+		// Read afresh each time, or the inlined static emission folds away entirely.
+		volatile int value = 1;
+
+		std::uint64_t iterations;
+		double seconds = measure([&](std::uint64_t n) {
+			for (std::uint64_t i = 0; i < n; ++i) {
+				dynamic(static_cast<int>(value));
+			}
+		}, iterations);
+		report("emit_static", "signals", 4, 1, iterations, seconds);
+
+		seconds = measure([&](std::uint64_t n) {
+			for (std::uint64_t i = 0; i < n; ++i) {
+				fixed(static_cast<int>(value));
+			}
+		}, iterations);
+		report("emit_static", "static_signal", 4, 1, iterations, seconds);
+
+		for (std::size_t i = 0; i < 4; ++i) {
+			g_sink += sinks[i].m_sum;
+		}
+	}
+
+	// A batch of 256 values emitted one at a time and through emit_batch(); ns per value.
+	void bench_emit_batch()
+	{
+		typedef Sink<single_threaded> sink_type;
+		const std::size_t fanouts[] = { 1, 64, 4096 };
+		const std::size_t batch_size = 256;
+		std::vector<std::tuple<int> > batch(batch_size, std::make_tuple(1));
+
+		for (std::size_t fanout : fanouts)
+		{
+			basic_signals<single_threaded, int> sig;
+			std::vector<sink_type> sinks(fanout);
+
+			for (std::size_t i = 0; i < fanout; ++i) {
+				sig.connect(&sinks[i], &sink_type::onInt);
+			}
+
+			std::uint64_t iterations;
+			double seconds = measure([&](std::uint64_t n) {
+				for (std::uint64_t i = 0; i < n; ++i)
+				{
+					for (std::size_t b = 0; b < batch.size(); ++b) {
+						sig(std::get<0>(batch[b]));
+					}
+				}
+			}, iterations);
+			report("emit_batch", "emit_each", fanout, 1, iterations * batch_size, seconds);
+
+			seconds = measure([&](std::uint64_t n) {
+				for (std::uint64_t i = 0; i < n; ++i) {
+					sig.emit_batch(batch);
+				}
+			}, iterations);
+			report("emit_batch", "emit_batch", fanout, 1, iterations * batch_size, seconds);
+
+			for (std::size_t i = 0; i < fanout; ++i) {
+				g_sink += sinks[i].m_sum;
+			}
+		}
+	}
+
+	// Emission into a queued and a conflated connection, dispatching every param emissions,
+	// as a receiver that falls behind the emitter would.
+	void bench_emit_queued()
+	{
+		typedef Sink<multi_threaded_local> sink_type;
+		const std::size_t batches[] = { 1, 1024 };
+
+		for (std::size_t batch : batches)
+		{
+			dispatcher queue;
+			sink_type queued_sink;
+			sink_type latest_sink;
+			basic_signals<multi_threaded_local, int> queued;
+			basic_signals<multi_threaded_local, int> latest;
+			queued.connect(&queued_sink, &sink_type::onInt, queue);
+			latest.connect_latest(&latest_sink, &sink_type::onInt, queue);
+
+			std::uint64_t iterations;
+			double seconds = measure([&](std::uint64_t n) {
+				for (std::uint64_t i = 0; i < n; ++i)
+				{
+					queued(1);
+					if ((i + 1) % batch == 0) {
+						queue.dispatch();
+					}
+				}
+				queue.dispatch();
+			}, iterations);
+			report("emit_queued", "queued", batch, 1, iterations, seconds);
+
+			seconds = measure([&](std::uint64_t n) {
+				for (std::uint64_t i = 0; i < n; ++i)
+				{
+					latest(1);
+					if ((i + 1) % batch == 0) {
+						queue.dispatch();
+					}
+				}
+				queue.dispatch();
+			}, iterations);
+			report("emit_queued", "latest", batch, 1, iterations, seconds);
+
+			g_sink += queued_sink.m_sum + latest_sink.m_sum;
+		}
+	}
+
+	// Serial emission against emit_parallel() on pools of 1 and 3 workers (2 and 4 threads
+	// counting the caller).
+	void bench_emit_parallel()
+	{
+		typedef AtomicSink<multi_threaded_local> sink_type;
+		const std::size_t fanouts[] = { 4096, 65536 };
+		const unsigned worker_counts[] = { 1, 3 };
+
+		for (std::size_t fanout : fanouts)
+		{
+			basic_signals<multi_threaded_local, int> sig;
+			std::vector<sink_type> sinks(fanout);
+
+			for (std::size_t i = 0; i < fanout; ++i) {
+				sig.connect(&sinks[i], &sink_type::onInt);
+			}
+
+			std::uint64_t iterations;
+			double seconds = measure([&](std::uint64_t n) {
+				for (std::uint64_t i = 0; i < n; ++i) {
+					sig(1);
+				}
+			}, iterations);
+			report("emit_parallel", "serial", fanout, 1, iterations, seconds);
+
+			for (unsigned workers : worker_counts)
+			{
+				thread_pool pool(workers);
+
+				seconds = measure([&](std::uint64_t n) {
+					for (std::uint64_t i = 0; i < n; ++i) {
+						sig.emit_parallel(pool, 1);
+					}
+				}, iterations);
+				report("emit_parallel", "thread_pool", fanout, workers + 1, iterations, seconds);
+			}
+		}
+	}
+
+	void print_csv()
+	{
+		std::printf("benchmark,variant,param,threads,iterations,ns_per_op\n");
+
+		for (std::size_t i = 0; i < g_results.size(); ++i)
+		{
+			const Result& r = g_results[i];
+			std::printf("%s,%s,%zu,%u,%llu,%.3f\n", r.m_benchmark.c_str(), r.m_variant.c_str(), r.m_param,
+				r.m_threads, static_cast<unsigned long long>(r.m_iterations), r.m_ns_per_op);
+		}
+	}
+
+	void print_json()
+	{
+		std::printf("[\n");
+
+		for (std::size_t i = 0; i < g_results.size(); ++i)
+		{
+			const Result& r = g_results[i];
+			std::printf("  {\"benchmark\": \"%s\", \"variant\": \"%s\", \"param\": %zu, \"threads\": %u, \"iterations\": %llu, \"ns_per_op\": %.3f}%s\n",
+				r.m_benchmark.c_str(), r.m_variant.c_str(), r.m_param, r.m_threads,
+				static_cast<unsigned long long>(r.m_iterations), r.m_ns_per_op, i + 1 < g_results.size() ? "," : "");
+		}
+
+		std::printf("]\n");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	bool json = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--json") == 0) {
+			json = true;
+		}
+		else if (std::strcmp(argv[i], "--quick") == 0) {
+			g_min_seconds = 0.002;
+		}
+		else {
+			std::fprintf(stderr, "usage: %s [--json] [--quick]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	bench_emit_fanout<single_threaded>("single_threaded");
+	bench_emit_fanout<multi_threaded_global>("multi_threaded_global");
+	bench_emit_fanout<copy_on_write<multi_threaded_local> >("copy_on_write");
+	bench_emit_compact();
+	bench_emit_lazy();
+	bench_emit_veto();
+	bench_emit_fanout_lambda();
+	bench_emit_fanout_function();
+	bench_emit_args();
+	bench_emit_static();
+	bench_emit_batch();
+	bench_churn();
+	bench_teardown();
+	bench_relocate();
+	bench_threads<multi_threaded_global>("multi_threaded_global");
+	bench_threads<multi_threaded_local>("multi_threaded_local");
+	bench_threads<multi_threaded_striped>("multi_threaded_striped");
+	bench_threads<multi_threaded_spin>("multi_threaded_spin");
+	bench_threads<multi_threaded_adaptive>("multi_threaded_adaptive");
+#if __cplusplus >= 201703L
+	bench_threads<multi_threaded_shared>("multi_threaded_shared");
+#endif
+	bench_threads<copy_on_write<multi_threaded_local> >("copy_on_write");
+	bench_threads_scaling<multi_threaded_local>("multi_threaded_local");
+	bench_threads_scaling<copy_on_write<multi_threaded_local> >("copy_on_write");
+	bench_emit_queued();
+	bench_emit_parallel();
+
+	if (json) {
+		print_json();
+	}
+	else {
+		print_csv();
+	}
+
+	// Keeps the slots' work observable.
+	return g_sink == 0 ? 1 : 0;
+}
@@ -91,12 +91,23 @@
 //    -First Release
 //****************************************************************************
 
-#include <sigslot.hpp>
-using namesapce sigslot;
+#include "sigslot.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace sigslot;
 
 struct Sender
 {
-	Synapse::sigslot::signals<std::string, int> signalSender;
+	signals<std::string, int> signalSender;
 
 	void help1() {
 		signalSender("Help1", 1);
@@ -107,11 +118,14 @@ struct Sender
 	}
 };
 
-struct Receiver :public Synapse::sigslot::has_slots
+struct Receiver : public has_slots
 {
+	int m_count = 0;
+
 	void onReceiver(std::string message, int type)
 	{
-		cout << message << endl;
+		std::cout << message << std::endl;
+		++m_count;
 
 		if (type == 1) {
 			std::cout << "correct slot" << std::endl;
@@ -122,14 +136,1854 @@ struct Receiver :public Synapse::sigslot::has_slots
 	}
 };
 
-int main()
+template<class mt_policy>
+struct Counter : public basic_has_slots<mt_policy>
 {
-	Sender sender;
-	Receiver rec;
-	sender.signalSender.connect(&rec, &Receiver::onReceiver);
+	int m_sum = 0;
 
-	sender.help1();
-	sender.help2();
+	void onValue(int value) {
+		m_sum += value;
+	}
+};
 
-	sender.signalSender.disconnect(&rec);
-}
\ No newline at end of file
+template<class mt_policy>
+void test_policy()
+{
+	basic_signals<mt_policy, int> sig;
+	{
+		Counter<mt_policy> a, b;
+		sig.connect(&a, &Counter<mt_policy>::onValue);
+		sig.connect(&b, &Counter<mt_policy>::onValue);
+
+		sig(2);
+		sig.emit(3);
+		assert(a.m_sum == 5 && b.m_sum == 5);
+
+		sig.disconnect(&a);
+		sig(1);
+		assert(a.m_sum == 5 && b.m_sum == 6);
+	}
+
+	// Receivers disconnected themselves on destruction.
+	sig(1);
+}
+
+// For slots that may run concurrently.
+template<class mt_policy>
+struct SharedCounter : public basic_has_slots<mt_policy>
+{
+	std::atomic<int> m_sum{0};
+
+	// Emitters on other threads may call in until the base destructor disconnects, by
+	// which time this part is gone.
+	~SharedCounter() {
+		this->disconnect_all();
+	}
+
+	void onValue(int value) {
+		m_sum += value;
+	}
+};
+
+// A signal connecting a receiver while the receiver disconnects from it: each takes
+// its own lock first, and neither may wait for the other's. Copies of either read it
+// under its lock.
+template<class mt_policy>
+void test_connect_teardown()
+{
+	basic_signals<mt_policy, int> sig;
+	Counter<mt_policy> rcv;
+
+	std::atomic<bool> done(false);
+	std::thread teardown([&] {
+		while (!done) {
+			rcv.disconnect_all();
+		}
+	});
+
+	std::thread copier([&] {
+		while (!done)
+		{
+			basic_signals<mt_policy, int> sig_copy(sig);
+			Counter<mt_policy> rcv_copy(rcv);
+		}
+	});
+
+	for (int i = 0; i < 2000; ++i) {
+		sig.connect(&rcv, &Counter<mt_policy>::onValue);
+	}
+
+	done = true;
+	teardown.join();
+	copier.join();
+	rcv.disconnect_all();
+	sig(1);
+	assert(rcv.m_sum == 0);
+}
+
+template<class mt_policy>
+void test_contended_policy()
+{
+	// Emitters and a writer on one signal; every emission sees a consistent list.
+	basic_signals<mt_policy, int> sig;
+	SharedCounter<mt_policy> stable;
+	sig.connect(&stable, &SharedCounter<mt_policy>::onValue);
+
+	std::atomic<bool> done(false);
+	std::atomic<int> emitted(0);
+	std::vector<std::thread> emitters;
+
+	for (int t = 0; t < 3; ++t) {
+		emitters.emplace_back([&] {
+			while (!done) {
+				sig(0);
+				++emitted;
+			}
+		});
+	}
+
+	for (int i = 0; i < 200; ++i)
+	{
+		SharedCounter<mt_policy> churn;
+		sig.connect(&churn, &SharedCounter<mt_policy>::onValue);
+	}
+
+	done = true;
+	for (std::size_t t = 0; t < emitters.size(); ++t) {
+		emitters[t].join();
+	}
+
+	sig(1);
+	assert(stable.m_sum == 1);
+	test_connect_teardown<mt_policy>();
+}
+
+// Two unrelated signal/receiver pairs whose stripes are swapped: connecting one pair
+// while the other's receiver disconnects must not deadlock.
+void test_striped_ordering()
+{
+	typedef basic_signals<multi_threaded_striped, int> signal_type;
+	typedef Counter<multi_threaded_striped> receiver_type;
+	std::vector<std::unique_ptr<signal_type> > signals;
+	std::vector<std::unique_ptr<receiver_type> > receivers;
+	signal_type* sig1 = nullptr;
+	signal_type* sig2 = nullptr;
+	receiver_type* rcv1 = nullptr;
+	receiver_type* rcv2 = nullptr;
+
+	while (!sig1 || !sig2 || !rcv1 || !rcv2)
+	{
+		signals.emplace_back(new signal_type);
+		receivers.emplace_back(new receiver_type);
+		signal_type* sig = signals.back().get();
+		receiver_type* rcv = receivers.back().get();
+
+		if (!sig1) {
+			sig1 = sig;
+		}
+		else if (!sig2 && sig->lock_key() != sig1->lock_key()) {
+			sig2 = sig;
+		}
+
+		if (sig2 && !rcv1 && rcv->lock_key() == sig2->lock_key()) {
+			rcv1 = rcv;
+		}
+		else if (sig2 && !rcv2 && rcv->lock_key() == sig1->lock_key()) {
+			rcv2 = rcv;
+		}
+	}
+
+	std::atomic<bool> done(false);
+	std::thread teardown([&] {
+		while (!done)
+		{
+			sig2->connect(rcv2, &receiver_type::onValue);
+			rcv2->disconnect_all();
+		}
+	});
+
+	for (int i = 0; i < 20000; ++i)
+	{
+		sig1->connect(rcv1, &receiver_type::onValue);
+		sig1->disconnect_all();
+	}
+
+	done = true;
+	teardown.join();
+
+	// Slots emitting each other's signal on two threads at once: an emission lets go of
+	// its stripe before calling slots.
+	std::atomic<int> calls(0);
+	sig1->connect([&](int depth) { ++calls; if (depth) (*sig2)(depth - 1); });
+	sig2->connect([&](int depth) { ++calls; if (depth) (*sig1)(depth - 1); });
+	std::thread pong([&] {
+		for (int i = 0; i < 5000; ++i) {
+			(*sig2)(1);
+		}
+	});
+
+	for (int i = 0; i < 5000; ++i) {
+		(*sig1)(1);
+	}
+
+	pong.join();
+	assert(calls == 20000);
+}
+
+void test_lock_policies()
+{
+	// Striped objects carry no lock of their own.
+	static_assert(sizeof(basic_has_slots<multi_threaded_striped>) == sizeof(basic_has_slots<single_threaded>),
+		"striped receivers are as small as single threaded ones");
+
+	// The policies are recursive: a slot may rewire the signal calling it.
+	basic_signals<multi_threaded_spin, int> sig;
+	Counter<multi_threaded_spin> counter;
+	sig.connect([&](int) { sig.disconnect(&counter); });
+	sig.connect(&counter, &Counter<multi_threaded_spin>::onValue);
+	sig(1);
+	sig(1);
+	assert(counter.m_sum == 0);
+
+	test_connect_teardown<multi_threaded_global>();
+	test_connect_teardown<multi_threaded_local>();
+	test_contended_policy<multi_threaded_striped>();
+	test_striped_ordering();
+	test_contended_policy<multi_threaded_spin>();
+	test_contended_policy<multi_threaded_adaptive>();
+#if __cplusplus >= 201703L
+	test_contended_policy<multi_threaded_shared>();
+#endif
+}
+
+void test_fan_out()
+{
+	// More receivers than the inline capacity, so the storage spills to the heap.
+	signals<int> sig;
+	std::vector<Counter<SIGSLOT_DEFAULT_MT_POLICY> > receivers(3 * SIGSLOT_INLINE_CONNECTIONS);
+
+	for (std::size_t i = 0; i < receivers.size(); ++i) {
+		sig.connect(&receivers[i], &Counter<SIGSLOT_DEFAULT_MT_POLICY>::onValue);
+	}
+
+	sig(1);
+
+	for (std::size_t i = 0; i < receivers.size(); i += 2) {
+		sig.disconnect(&receivers[i]);
+	}
+
+	sig(1);
+
+	for (std::size_t i = 0; i < receivers.size(); ++i) {
+		assert(receivers[i].m_sum == (i % 2 ? 2 : 1));
+	}
+}
+
+struct Base
+{
+	int m_base = 0;
+	virtual ~Base() {}
+};
+
+// has_slots is not the first base, so the receiver and has_slots addresses differ.
+struct Derived : public Base, public has_slots
+{
+	int m_sum = 0;
+
+	void onValue(int value) {
+		m_sum += value;
+	}
+};
+
+void test_delegates()
+{
+	signals<int> sig;
+	Derived a;
+	sig.connect(&a, &Derived::onValue);
+
+#if __cplusplus >= 201703L
+	sig.connect<&Derived::onValue>(&a);
+#else
+	sig.connect(&a, &Derived::onValue);
+#endif
+
+	// Copying a receiver duplicates its connections onto the copy.
+	Derived b(a);
+	sig(1);
+	assert(a.m_sum == 2 && b.m_sum == 2);
+
+	// Copying a signal copies its connections.
+	signals<int> copy(sig);
+	copy(2);
+	assert(a.m_sum == 6 && b.m_sum == 6);
+}
+
+struct Recorder : public has_slots
+{
+	std::vector<int>* m_log = nullptr;
+	int m_id = 0;
+
+	void onValue(int) {
+		m_log->push_back(m_id);
+	}
+};
+
+void test_handles()
+{
+	signals<int> sig;
+	std::vector<int> log;
+	std::vector<Recorder> receivers(8);
+	std::vector<connection> handles;
+
+	for (std::size_t i = 0; i < receivers.size(); ++i)
+	{
+		receivers[i].m_log = &log;
+		receivers[i].m_id = static_cast<int>(i);
+		handles.push_back(sig.connect(&receivers[i], &Recorder::onValue));
+	}
+
+	assert(sig.disconnect(handles[3]));
+	assert(!sig.disconnect(handles[3]));
+	assert(!sig.connected(handles[3]));
+	assert(!sig.disconnect(connection()));
+
+	// Enough removals to trigger compaction; invocation order is kept.
+	for (std::size_t i = 4; i < receivers.size(); i += 2) {
+		assert(sig.disconnect(handles[i]));
+	}
+
+	sig(0);
+	int expected[] = { 0, 1, 2, 5, 7 };
+	assert(log == std::vector<int>(expected, expected + 5));
+
+	// A reused slot gets a new generation, so the old handle stays dead.
+	connection reused = sig.connect(&receivers[3], &Recorder::onValue);
+	assert(reused.index() == handles[6].index() && reused.generation() != handles[6].generation());
+	assert(sig.connected(reused) && !sig.connected(handles[6]));
+	assert(!sig.disconnect(handles[6]));
+	assert(sig.disconnect(reused));
+
+	// Made-up or stale handles that match the generation of a free slot reach nothing.
+	signals<int> other;
+	std::vector<int> other_log;
+	Recorder first, second;
+	first.m_log = second.m_log = &other_log;
+	connection h1 = other.connect(&first, &Recorder::onValue);
+	connection h2 = other.connect(&second, &Recorder::onValue);
+	assert(other.disconnect(h1) && other.connected(h2));
+
+	for (std::uint32_t generation = 0; generation < 4; ++generation)
+	{
+		assert(!other.connected(connection(h1.index(), generation)));
+		assert(!other.disconnect(connection(h1.index(), generation)));
+	}
+
+	other(0);
+	assert(other.connected(h2) && other_log.size() == 1);
+
+	// The last free slot's link is the end of the free list.
+	signals<int> single;
+	connection only = single.connect(&first, &Recorder::onValue);
+	assert(single.disconnect(only));
+	assert(!single.connected(connection(only.index(), only.generation() + 1)));
+	assert(!single.disconnect(connection(only.index(), only.generation() + 1)));
+}
+
+void test_teardown()
+{
+	typedef Counter<SIGSLOT_DEFAULT_MT_POLICY> counter_type;
+	Counter<SIGSLOT_DEFAULT_MT_POLICY> survivor;
+	std::vector<signals<int> > sigs(3);
+
+	{
+		counter_type doomed;
+
+		for (std::size_t i = 0; i < sigs.size(); ++i)
+		{
+			sigs[i].connect(&survivor, &counter_type::onValue);
+			sigs[i].connect(&doomed, &counter_type::onValue);
+			sigs[i].connect(&doomed, &counter_type::onValue);
+		}
+
+		sigs[0](1);
+		assert(doomed.m_sum == 2);
+	}
+
+	// The destroyed receiver took only its own connections with it.
+	for (std::size_t i = 0; i < sigs.size(); ++i) {
+		sigs[i](1);
+	}
+
+	assert(survivor.m_sum == 4);
+
+	// A signal going first unlinks itself from the receivers it still reaches.
+	{
+		signals<int> shortlived;
+		shortlived.connect(&survivor, &counter_type::onValue);
+	}
+
+	sigs.clear();
+	survivor.disconnect_all();
+}
+
+struct Payload
+{
+	static int s_copies;
+	static int s_moves;
+
+	std::string m_text;
+
+	explicit Payload(const char* text)
+		: m_text(text)
+	{}
+
+	Payload(const Payload& p)
+		: m_text(p.m_text)
+	{
+		++s_copies;
+	}
+
+	Payload(Payload&& p)
+		: m_text(std::move(p.m_text))
+	{
+		++s_moves;
+	}
+};
+
+int Payload::s_copies = 0;
+int Payload::s_moves = 0;
+
+struct PayloadSink : public has_slots
+{
+	std::string m_last;
+
+	void byRef(const Payload& p) {
+		m_last = p.m_text;
+	}
+
+	void byValue(Payload p) {
+		m_last = p.m_text;
+	}
+};
+
+void test_argument_passing()
+{
+	signals<Payload> sig;
+	PayloadSink a, b, c;
+	sig.connect(&a, &PayloadSink::byRef);
+	sig.connect(&b, &PayloadSink::byValue);
+	sig.connect(&c, &PayloadSink::byValue);
+
+	// Lvalue: only by-value slots copy; the const& slot sees the caller's object.
+	Payload payload("lvalue");
+	Payload::s_copies = Payload::s_moves = 0;
+	sig(payload);
+	assert(Payload::s_copies == 2 && Payload::s_moves == 0);
+	assert(payload.m_text == "lvalue" && c.m_last == "lvalue");
+
+	// Rvalue: the last slot is moved into instead of copied.
+	Payload::s_copies = Payload::s_moves = 0;
+	sig(Payload("rvalue"));
+	assert(Payload::s_copies == 1 && Payload::s_moves == 1);
+	assert(a.m_last == "rvalue" && b.m_last == "rvalue" && c.m_last == "rvalue");
+}
+
+class CountingResource : public memory_resource
+{
+public:
+	int m_live = 0;
+	int m_total = 0;
+
+protected:
+	virtual void* do_allocate(std::size_t bytes, std::size_t alignment)
+	{
+		++m_live;
+		++m_total;
+		return get_default_resource()->allocate(bytes, alignment);
+	}
+
+	virtual void do_deallocate(void* p, std::size_t bytes, std::size_t alignment)
+	{
+		--m_live;
+		get_default_resource()->deallocate(p, bytes, alignment);
+	}
+
+	virtual bool do_is_equal(const memory_resource& other) const noexcept {
+		return this == &other;
+	}
+};
+
+void test_memory_resource()
+{
+	typedef Counter<SIGSLOT_DEFAULT_MT_POLICY> counter_type;
+	CountingResource resource;
+
+	{
+		signals<int> sig(&resource);
+		assert(sig.get_memory_resource() == &resource);
+
+		std::vector<counter_type> receivers(2 * SIGSLOT_INLINE_CONNECTIONS);
+
+		for (std::size_t i = 0; i < receivers.size(); ++i) {
+			sig.connect(&receivers[i], &counter_type::onValue);
+		}
+
+		// One link per connection, plus the spilled connection array and slot map.
+		assert(resource.m_live == static_cast<int>(receivers.size()) + 2);
+
+		sig(1);
+		assert(receivers.back().m_sum == 1);
+
+		// A callable too large to live in the connection is kept in the resource, and so is
+		// its copy in a copied signal.
+		std::string tag = "callable";
+		int calls = 0;
+		int before = resource.m_live;
+		connection handle = sig.connect([tag, &calls](int) { calls += static_cast<int>(tag.size()); });
+		assert(resource.m_live == before + 2);
+
+		{
+			signals<int> copy(sig, &resource);
+			copy(1);
+		}
+
+		assert(resource.m_live == before + 2 && calls == 8);
+		sig.disconnect(handle);
+		assert(resource.m_live == before);
+	}
+
+	assert(resource.m_live == 0 && resource.m_total > 0);
+
+#if __cplusplus >= 201703L
+	// Any std::pmr resource works, e.g. an arena for a burst of rewiring.
+	std::pmr::monotonic_buffer_resource arena;
+	signals<int> sig(&arena);
+	counter_type receiver;
+	sig.connect(&receiver, &counter_type::onValue);
+	sig(2);
+	assert(receiver.m_sum == 2);
+#endif
+}
+
+struct AtomicCounter : public basic_has_slots<multi_threaded_local>
+{
+	std::atomic<int> m_sum{0};
+
+	void onValue(int value) {
+		m_sum += value;
+	}
+};
+
+struct SelfDisconnect : public basic_has_slots<multi_threaded_local>
+{
+	basic_signals<copy_on_write<multi_threaded_local>, int>* m_signal = nullptr;
+	int m_calls = 0;
+
+	void onValue(int) {
+		++m_calls;
+		m_signal->disconnect(this);
+	}
+};
+
+void test_copy_on_write()
+{
+	typedef basic_signals<copy_on_write<multi_threaded_local>, int> signal_type;
+	signal_type sig;
+
+	AtomicCounter stable;
+	sig.connect(&stable, &AtomicCounter::onValue);
+
+	// Slots may rewire the signal they are called from.
+	SelfDisconnect self;
+	self.m_signal = &sig;
+	sig.connect(&self, &SelfDisconnect::onValue);
+	sig(1);
+	sig(1);
+	assert(self.m_calls == 1 && stable.m_sum == 2);
+
+	// Emitters never block on writers churning connections.
+	std::atomic<bool> done{false};
+	std::vector<std::thread> emitters;
+
+	for (int t = 0; t < 2; ++t) {
+		emitters.emplace_back([&] {
+			while (!done) {
+				sig(1);
+			}
+		});
+	}
+
+	// Receivers must outlive any emission that may still be running their slot.
+	std::vector<AtomicCounter> churn(100);
+
+	for (int i = 0; i < 1000; ++i) {
+		AtomicCounter* receiver = &churn[i % churn.size()];
+		sig.connect(receiver, &AtomicCounter::onValue);
+		sig.disconnect(receiver);
+	}
+
+	done = true;
+	for (std::size_t t = 0; t < emitters.size(); ++t) {
+		emitters[t].join();
+	}
+
+	int before = stable.m_sum;
+	sig(1);
+	assert(stable.m_sum == before + 1);
+}
+
+std::atomic<int> g_reclaimed(0);
+
+void reclaimInt(void* p)
+{
+	delete static_cast<int*>(p);
+	++g_reclaimed;
+}
+
+void test_epoch_reclamation()
+{
+	_epoch_domain& domain = _epoch_domain::instance();
+	std::atomic<int> stage(0);
+
+	// A block retired while an emitter is inside an epoch outlives that emission.
+	std::thread emitter([&] {
+		_epoch_guard epoch;
+		{
+			_epoch_guard nested;
+		}
+		stage = 1;
+		while (stage != 2) {
+			std::this_thread::yield();
+		}
+	});
+
+	while (stage != 1) {
+		std::this_thread::yield();
+	}
+
+	domain.retire(new int(1), &reclaimInt);
+	domain.retire(new int(2), &reclaimInt);
+	assert(g_reclaimed == 0);
+
+	stage = 2;
+	emitter.join();
+	domain.retire(new int(3), &reclaimInt);
+	assert(g_reclaimed == 3);
+}
+
+struct Inbox : public basic_has_slots<multi_threaded_local>
+{
+	std::thread::id m_owner = std::this_thread::get_id();
+	std::vector<int> m_values;
+	std::string m_last;
+
+	void onMessage(int value, const std::string& text)
+	{
+		assert(std::this_thread::get_id() == m_owner);
+		m_values.push_back(value);
+		m_last = text;
+	}
+};
+
+void test_queued_connections()
+{
+	typedef basic_signals<multi_threaded_local, int, std::string> signal_type;
+	dispatcher queue;
+	signal_type sig;
+
+	// Nothing runs on the emitting thread; the arguments are copies.
+	Inbox inbox;
+	connection handle = sig.connect(&inbox, &Inbox::onMessage, queue);
+	std::thread([&] {
+		std::string text = "first";
+		sig(1, text);
+		text = "changed";
+		sig(2, std::string("second"));
+	}).join();
+	assert(inbox.m_values.empty());
+	assert(queue.dispatch() == 2);
+	assert(inbox.m_values.size() == 2 && inbox.m_values[0] == 1 && inbox.m_last == "second");
+
+	// Calls pending at disconnect are dropped.
+	sig(3, "dropped");
+	assert(sig.disconnect(handle));
+	assert(queue.dispatch() == 1 && inbox.m_values.size() == 2);
+
+	// Including when the receiver goes away, and copies keep queued connections.
+	{
+		Inbox* doomed = new Inbox;
+		sig.connect(doomed, &Inbox::onMessage, queue);
+		Inbox copy(*doomed);
+		sig(4, "pending");
+		delete doomed;
+		queue.dispatch();
+		assert(copy.m_values.size() == 1 && copy.m_values[0] == 4);
+		sig(5, "left in queue");
+	}
+
+	// Producers on many threads; each one's calls arrive in order.
+	sig.connect(&inbox, &Inbox::onMessage, queue);
+	inbox.m_values.clear();
+	std::vector<std::thread> producers;
+
+	for (int t = 0; t < 4; ++t) {
+		producers.emplace_back([&sig, t] {
+			for (int i = 0; i < 1000; ++i) {
+				sig(t * 1000 + i, "");
+			}
+		});
+	}
+
+	std::size_t received = 0;
+	while (received < 4000) {
+		received += queue.dispatch();
+	}
+
+	for (std::size_t t = 0; t < producers.size(); ++t) {
+		producers[t].join();
+	}
+
+	int next[4] = { 0, 1000, 2000, 3000 };
+	for (std::size_t i = 0; i < inbox.m_values.size(); ++i) {
+		int value = inbox.m_values[i];
+		assert(value == next[value / 1000]++);
+	}
+	assert(inbox.m_values.size() == 4000);
+
+	// Calls never dispatched are freed with the dispatcher.
+	sig(6, "never dispatched");
+}
+
+int g_free_calls = 0;
+
+void freeSlot(int value)
+{
+	g_free_calls += value;
+}
+
+void test_callables()
+{
+	typedef basic_signals<single_threaded, int> signal_type;
+	signal_type sig;
+
+	int sum = 0;
+	auto add = [&sum](int value) { sum += value; };
+	static_assert(_fits_inline<decltype(add)>::value, "a lambda capturing a reference is stored inline");
+	connection lambda = sig.connect(add);
+	sig.connect(&freeSlot);
+
+	int calls = 0;
+	int count = 0;
+	sig.connect([&calls, count](int) mutable { calls = ++count; });
+
+	// Too large for inline storage: owned by the connection, cloned with the signal.
+	std::string prefix(100, 'x');
+	std::string seen;
+	connection large = sig.connect([prefix, &seen](int value) { seen = prefix + std::to_string(value); });
+
+	sig(2);
+	assert(sum == 2 && g_free_calls == 2 && calls == 1 && seen == prefix + "2");
+
+	{
+		signal_type copy(sig);
+		copy(3);
+		assert(sum == 5 && g_free_calls == 5 && calls == 2 && seen == prefix + "3");
+		assert(copy.disconnect(large) && !copy.connected(large) && sig.connected(large));
+	}
+
+	assert(sig.disconnect(lambda) && sig.disconnect(large));
+	sig(1);
+	assert(sum == 5 && g_free_calls == 6 && calls == 2);
+
+	// Callables and receivers share one signal; disconnect(receiver) leaves callables be.
+	Counter<single_threaded> receiver;
+	sig.connect(&receiver, &Counter<single_threaded>::onValue);
+	sig.disconnect(&receiver);
+	sig.disconnect_all();
+	sig(1);
+	assert(g_free_calls == 6);
+
+	// A mutable lambda keeps its state out of line, so copy_on_write republishing its
+	// snapshot for unrelated connections does not reset it.
+	auto counting = [&calls, count](int) mutable { calls = ++count; };
+	static_assert(_fits_inline<decltype(counting)>::value, "small enough to fit");
+	static_assert(!_const_callable<decltype(counting), int>::value, "but needs to change its state");
+
+	basic_signals<copy_on_write<single_threaded>, int> snapshot;
+	snapshot.connect(counting);
+	count = calls = 0;
+
+	for (int i = 0; i < 4; ++i)
+	{
+		snapshot(0);
+		snapshot.connect(&freeSlot);
+	}
+
+	assert(calls == 4);
+
+	// An inline slot that connects to its own signal, growing the connection array under
+	// it, still finishes with its own captures intact.
+	signal_type growing;
+	signal_type* target = &growing;
+	int* grown = &calls;
+	calls = 0;
+
+	for (int i = 0; i < 7; ++i) {
+		growing.connect(&freeSlot);
+	}
+
+	growing.connect([target, grown](int) {
+		for (int i = 0; i < 32; ++i) {
+			target->connect(&freeSlot);
+		}
+		++*grown;
+	});
+
+	growing(0);
+	growing(0);
+	assert(calls == 2);
+}
+
+void test_deferred_release()
+{
+	// A slot that disconnects itself keeps its captures until it returns.
+	basic_signals<multi_threaded_local, int> locked;
+	std::string text(100, 'a');
+	std::size_t seen = 0;
+	connection self;
+	self = locked.connect([&locked, &self, &seen, text](int) {
+		locked.disconnect(self);
+		seen = text.size();
+	});
+	locked(1);
+	assert(seen == 100 && !locked.connected(self));
+
+	// Targets of connections dropped under concurrent copy_on_write emission stay
+	// alive for every emitter that may still call them.
+	typedef basic_signals<copy_on_write<multi_threaded_local>, int> signal_type;
+	signal_type sig;
+	std::atomic<bool> done(false);
+	std::atomic<std::size_t> calls(0);
+	std::vector<std::thread> emitters;
+
+	for (int t = 0; t < 2; ++t) {
+		emitters.emplace_back([&] {
+			while (!done) {
+				sig(1);
+			}
+		});
+	}
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		std::string capture(64, 'x');
+		connection handle = sig.connect([capture, &calls](int) { calls += capture.size(); });
+		sig.disconnect(handle);
+	}
+
+	done = true;
+	for (std::size_t t = 0; t < emitters.size(); ++t) {
+		emitters[t].join();
+	}
+
+	assert(calls % 64 == 0);
+}
+
+struct Strategy : public basic_has_slots<multi_threaded_local>
+{
+	std::atomic<bool> m_entered{false};
+	std::atomic<bool> m_release{false};
+	std::string m_name = "strategy";
+	int m_calls = 0;
+
+	~Strategy() {
+		disconnect_all_and_wait();
+	}
+
+	void onTick(int)
+	{
+		m_entered = true;
+		while (!m_release) {
+			std::this_thread::yield();
+		}
+		m_calls += static_cast<int>(m_name.size());
+	}
+};
+
+void test_disconnect_and_wait()
+{
+	typedef basic_signals<copy_on_write<multi_threaded_local>, int> signal_type;
+	signal_type sig;
+
+	// The receiver's teardown waits for a call running on another thread.
+	Strategy strategy;
+	sig.connect(&strategy, &Strategy::onTick);
+	std::thread emitter([&] { sig(1); });
+
+	while (!strategy.m_entered) {
+		std::this_thread::yield();
+	}
+
+	std::atomic<bool> returned(false);
+	std::thread teardown([&] {
+		strategy.disconnect_all_and_wait();
+		returned = true;
+	});
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	assert(!returned);
+	strategy.m_release = true;
+	teardown.join();
+	assert(returned && strategy.m_calls == 8);
+	emitter.join();
+
+	sig(1);
+	assert(strategy.m_calls == 8);
+
+	// By handle; stale handles are refused.
+	AtomicCounter counter;
+	connection handle = sig.connect(&counter, &AtomicCounter::onValue);
+	sig(2);
+	assert(sig.disconnect_and_wait(handle) && !sig.disconnect_and_wait(handle));
+	sig(2);
+	assert(counter.m_sum == 2);
+
+	// Emissions on the waiting thread itself are not waited for, so a slot may drop its
+	// own connection and wait for any other thread still calling it.
+	connection self;
+	int self_calls = 0;
+	self = sig.connect([&sig, &self, &self_calls](int) {
+		++self_calls;
+		assert(sig.disconnect_and_wait(self));
+	});
+	sig(3);
+	sig(3);
+	assert(self_calls == 1);
+
+	// Slots waiting on two threads at once wait only for calls of the connections they
+	// drop, not for each other's emissions.
+	std::atomic<int> inside(0);
+	std::vector<std::thread> waiters;
+
+	for (int t = 0; t < 2; ++t) {
+		waiters.emplace_back([&inside] {
+			signal_type own;
+			AtomicCounter victim;
+			connection handle = own.connect(&victim, &AtomicCounter::onValue);
+			own.connect([&own, &handle, &inside](int) {
+				++inside;
+				while (inside < 2) {
+					std::this_thread::yield();
+				}
+				assert(own.disconnect_and_wait(handle));
+			});
+			own(1);
+			assert(victim.m_sum == 1 && !own.connected(handle));
+		});
+	}
+
+	for (std::size_t t = 0; t < waiters.size(); ++t) {
+		waiters[t].join();
+	}
+
+	// Locked emission already excludes disconnects, so the locked variant needs no waiting.
+	basic_signals<multi_threaded_local, int> locked;
+	handle = locked.connect(&counter, &AtomicCounter::onValue);
+	assert(locked.disconnect_and_wait(handle) && !locked.connected(handle));
+}
+
+template<class mt_policy>
+struct BasicQuotes : public basic_has_slots<mt_policy>
+{
+	std::vector<std::string> m_symbols;
+	std::vector<int> m_prices;
+
+	void onQuote(const std::string& symbol, int price)
+	{
+		m_symbols.push_back(symbol);
+		m_prices.push_back(price);
+	}
+};
+
+typedef BasicQuotes<multi_threaded_local> Quotes;
+
+// A fast producer against a slow consumer: every delivery is newer than the last and
+// the final value always arrives. The pending values have their own lock, so even a
+// single_threaded signal may be emitted on one thread and dispatched on another.
+template<class mt_policy>
+void test_conflated_producer()
+{
+	dispatcher queue;
+	basic_signals<mt_policy, std::string, int> sig;
+	BasicQuotes<mt_policy> slow;
+	sig.connect_latest(&slow, &BasicQuotes<mt_policy>::onQuote, queue);
+	std::atomic<bool> done(false);
+	std::thread producer([&] {
+		for (int i = 1; i <= 100000; ++i) {
+			sig("ABC", i);
+		}
+		done = true;
+	});
+
+	while (!done) {
+		queue.dispatch();
+	}
+
+	producer.join();
+	queue.dispatch();
+
+	for (std::size_t i = 1; i < slow.m_prices.size(); ++i) {
+		assert(slow.m_prices[i] > slow.m_prices[i - 1]);
+	}
+	assert(slow.m_prices.back() == 100000 && slow.m_prices.size() <= 100000);
+}
+
+void test_conflated_connections()
+{
+	typedef basic_signals<multi_threaded_local, std::string, int> signal_type;
+	dispatcher queue;
+	signal_type sig;
+
+	// Only the latest values are delivered, once per dispatch.
+	Quotes latest;
+	connection handle = sig.connect_latest(&latest, &Quotes::onQuote, queue);
+	sig("ABC", 1);
+	sig("DEF", 2);
+	sig(std::string("ABC"), 3);
+	assert(latest.m_prices.empty());
+	assert(queue.dispatch() == 1);
+	assert(latest.m_prices.size() == 1 && latest.m_symbols[0] == "ABC" && latest.m_prices[0] == 3);
+	assert(queue.dispatch() == 0);
+
+	sig("GHI", 4);
+	assert(queue.dispatch() == 1 && latest.m_prices.size() == 2 && latest.m_prices[1] == 4);
+
+	// Pending values are dropped at disconnect.
+	sig("JKL", 5);
+	assert(sig.disconnect(handle));
+	queue.dispatch();
+	assert(latest.m_prices.size() == 2);
+
+	// Keyed: the latest per symbol, in the order the symbols first arrived.
+	Quotes keyed;
+	sig.connect_latest(&keyed, &Quotes::onQuote, queue, [](const std::string& symbol, int) { return symbol; });
+	sig("ABC", 1);
+	sig("DEF", 2);
+	sig("ABC", 3);
+	sig("GHI", 4);
+	sig("DEF", 5);
+	assert(queue.dispatch() == 1);
+	assert(keyed.m_prices.size() == 3);
+	assert(keyed.m_symbols[0] == "ABC" && keyed.m_prices[0] == 3);
+	assert(keyed.m_symbols[1] == "DEF" && keyed.m_prices[1] == 5);
+	assert(keyed.m_symbols[2] == "GHI" && keyed.m_prices[2] == 4);
+
+	// Copies of the receiver get their own conflated connection.
+	{
+		Quotes copy(keyed);
+		copy.m_prices.clear();
+		sig("ABC", 6);
+		queue.dispatch();
+		assert(copy.m_prices.size() == 1 && copy.m_prices[0] == 6);
+	}
+
+	sig.disconnect_all();
+	test_conflated_producer<multi_threaded_local>();
+	test_conflated_producer<single_threaded>();
+}
+
+template<class mt_policy>
+void test_batch_policy()
+{
+	typedef basic_signals<mt_policy, int, std::string> signal_type;
+	signal_type sig;
+	std::vector<std::string> log;
+
+	sig.connect([&log](int value, const std::string& text) { log.push_back("a" + std::to_string(value) + text); });
+	sig.connect([&log](int value, const std::string&) { log.push_back("b" + std::to_string(value)); });
+
+	// Each slot runs over the whole batch before the next one starts.
+	std::vector<std::tuple<int, std::string> > batch;
+	batch.push_back(std::make_tuple(1, std::string("x")));
+	batch.push_back(std::make_tuple(2, std::string("y")));
+	batch.push_back(std::make_tuple(3, std::string("z")));
+	sig.emit_batch(batch);
+	assert(log.size() == 6);
+	assert(log[0] == "a1x" && log[1] == "a2y" && log[2] == "a3z");
+	assert(log[3] == "b1" && log[4] == "b2" && log[5] == "b3");
+
+	// An empty range calls nothing, and any range of tuples will do.
+	sig.emit_batch(batch.begin(), batch.begin());
+	std::tuple<int, std::string> array[] = { std::make_tuple(4, std::string("w")) };
+	sig.emit_batch(array, array + 1);
+	assert(log.size() == 8 && log[6] == "a4w" && log[7] == "b4");
+
+	// A slot that disconnects itself misses the rest of the batch.
+	log.clear();
+	connection self;
+	self = sig.connect([&sig, &self, &log](int value, const std::string&) {
+		log.push_back("c" + std::to_string(value));
+		sig.disconnect(self);
+	});
+	sig.emit_batch(batch);
+	assert(log.size() == 7 && log[6] == "c1");
+}
+
+void test_emit_batch()
+{
+	test_batch_policy<single_threaded>();
+	test_batch_policy<multi_threaded_local>();
+	test_batch_policy<copy_on_write<multi_threaded_local> >();
+
+	// Receivers too; reference arguments still refer to the batch's values.
+	basic_signals<multi_threaded_local, int> values;
+	Counter<multi_threaded_local> counter;
+	values.connect(&counter, &Counter<multi_threaded_local>::onValue);
+
+	std::vector<std::tuple<int> > batch;
+	for (int i = 1; i <= 4; ++i) {
+		batch.push_back(std::make_tuple(i));
+	}
+
+	values.emit_batch(batch);
+	assert(counter.m_sum == 10);
+
+	basic_signals<single_threaded, int&> refs;
+	refs.connect([](int& value) { value *= 2; });
+	int a = 1;
+	int b = 2;
+	std::vector<std::tuple<int&> > targets;
+	targets.push_back(std::tuple<int&>(a));
+	targets.push_back(std::tuple<int&>(b));
+	refs.emit_batch(targets);
+	assert(a == 2 && b == 4);
+}
+
+struct Chart
+{
+	std::string m_symbol;
+	int m_total = 0;
+
+	void onTick(const std::string& symbol, int price)
+	{
+		m_symbol = symbol;
+		m_total += price;
+	}
+};
+
+struct TickLog
+{
+	std::vector<std::string>* m_log;
+
+	void operator()(const std::string& symbol, int price) {
+		m_log->push_back(symbol + std::to_string(price));
+	}
+};
+
+void test_static_signal()
+{
+	typedef static_slot<decltype(&Chart::onTick), &Chart::onTick> chart_slot;
+	std::vector<std::string> log;
+	Chart chart;
+	TickLog logger = { &log };
+
+	static_signal<chart_slot, TickLog> ticks(&chart, &logger);
+	ticks("ABC", 2);
+	ticks.emit(std::string("DEF"), 3);
+	assert(chart.m_symbol == "DEF" && chart.m_total == 5);
+	assert(log.size() == 2 && log[0] == "ABC2" && log[1] == "DEF3");
+
+	// Slots are called in declaration order and can be rewired or unset.
+	Chart other;
+	ticks.connect<0>(&other);
+	ticks.disconnect<1>();
+	ticks("GHI", 4);
+	assert(chart.m_total == 5 && other.m_total == 4 && log.size() == 2);
+
+	static_signal<chart_slot, chart_slot> unwired;
+	unwired("JKL", 1);
+
+#if __cplusplus >= 201703L
+	static_signal<static_slot_of<&Chart::onTick> > shorthand(&chart);
+	shorthand("MNO", 10);
+	assert(chart.m_total == 15);
+#endif
+}
+
+void test_move_semantics()
+{
+	typedef Counter<multi_threaded_local> counter_type;
+	typedef basic_signals<multi_threaded_local, int> signal_type;
+	CountingResource resource;
+
+	// Moving a locked signal allocates nothing; assigning may, as the target lets go of
+	// its own connections.
+	static_assert(std::is_nothrow_move_constructible<signal_type>::value, "");
+	static_assert(!std::is_nothrow_move_assignable<signal_type>::value, "");
+	static_assert(!std::is_nothrow_move_constructible<basic_signals<copy_on_write<multi_threaded_local>, int> >::value, "");
+
+	{
+		// Growing a vector of receivers moves their connections without allocating.
+		signal_type sig(&resource);
+		std::vector<counter_type> receivers(2);
+		receivers.reserve(2);
+
+		for (std::size_t i = 0; i < receivers.size(); ++i) {
+			sig.connect(&receivers[i], &counter_type::onValue);
+		}
+
+		int allocations = resource.m_total;
+		receivers.push_back(counter_type());
+		assert(resource.m_total == allocations);
+
+		sig(1);
+		assert(receivers[0].m_sum == 1 && receivers[1].m_sum == 1 && receivers[2].m_sum == 0);
+
+		// The moved-from receiver has nothing left.
+		counter_type moved(std::move(receivers[0]));
+		sig(2);
+		assert(moved.m_sum == 3 && receivers[0].m_sum == 1);
+
+		// Move assignment drops the target's connections and takes over the source's.
+		signal_type other;
+		other.connect(&receivers[2], &counter_type::onValue);
+		receivers[2] = std::move(moved);
+		other(10);
+		sig(4);
+		assert(receivers[2].m_sum == 7 && moved.m_sum == 3);
+
+		// Erasing shifts the rest down by move assignment; connections follow.
+		receivers.erase(receivers.begin());
+		sig(1);
+		assert(receivers.size() == 2 && receivers[0].m_sum == 8 && receivers[1].m_sum == 8);
+	}
+	assert(resource.m_live == 0);
+
+	{
+		// Signals move their connections, handles stay valid.
+		signal_type first(&resource);
+		counter_type receiver;
+		int calls = 0;
+		connection handle = first.connect(&receiver, &counter_type::onValue);
+		first.connect([&calls](int) { ++calls; });
+
+		signal_type second(std::move(first));
+		first(1);
+		second(2);
+		assert(receiver.m_sum == 2 && calls == 1);
+		assert(second.connected(handle) && !first.connected(handle));
+
+		// Into a signal on another resource, whose links are then its own.
+		CountingResource other_resource;
+		{
+			signal_type third(&other_resource);
+			third = std::move(second);
+			third(3);
+			assert(receiver.m_sum == 5 && calls == 2);
+			assert(other_resource.m_live > 0 && third.disconnect(handle));
+
+			std::vector<signal_type> grown(1);
+			grown[0].connect(&receiver, &counter_type::onValue);
+			grown.resize(8);
+			grown[0](1);
+			assert(receiver.m_sum == 6);
+		}
+		assert(other_resource.m_live == 0);
+	}
+	assert(resource.m_live == 0);
+
+	{
+		// Queued and copy_on_write connections follow a moved receiver too.
+		dispatcher queue;
+		basic_signals<multi_threaded_local, int, std::string> queued;
+		basic_signals<copy_on_write<multi_threaded_local>, int> cow;
+		Inbox inbox;
+		counter_type counter;
+		queued.connect(&inbox, &Inbox::onMessage, queue);
+		cow.connect(&counter, &counter_type::onValue);
+
+		queued(1, "pending");
+		Inbox moved_inbox(std::move(inbox));
+		counter_type moved_counter(std::move(counter));
+		queued(2, "after");
+		cow(5);
+		queue.dispatch();
+		assert(inbox.m_values.empty());
+		assert(moved_inbox.m_values.size() == 2 && moved_inbox.m_last == "after");
+		assert(counter.m_sum == 0 && moved_counter.m_sum == 5);
+	}
+}
+
+void test_compact_signals()
+{
+	typedef Counter<multi_threaded_local> counter_type;
+	typedef basic_compact_signals<multi_threaded_local, int> signal_type;
+	static_assert(sizeof(signal_type) == sizeof(void*), "an unconnected compact signal is one pointer");
+
+	signal_type sig;
+	sig(1);
+	assert(!sig.disconnect(connection()));
+
+	int calls = 0;
+	connection handle;
+	{
+		counter_type receiver;
+		sig.connect(&receiver, &counter_type::onValue);
+		handle = sig.connect([&calls](int) { ++calls; });
+		sig(2);
+		assert(receiver.m_sum == 2 && calls == 1 && sig.connected(handle));
+
+		signal_type copy(sig);
+		copy(3);
+		assert(receiver.m_sum == 5 && calls == 2);
+
+		signal_type moved(std::move(copy));
+		copy(4);
+		moved(5);
+		assert(receiver.m_sum == 10 && calls == 3);
+	}
+
+	// The receiver left on its own; the callable stays until disconnected.
+	sig(1);
+	assert(calls == 4);
+	assert(sig.disconnect(handle) && !sig.connected(handle));
+	sig(1);
+	assert(calls == 4);
+
+	// One connection lives in a record under a third the size of a basic_signals; a
+	// second moves it there, handle and all.
+	static_assert(sizeof(_single_signal<multi_threaded_global, int>) * 3 < sizeof(basic_signals<multi_threaded_global, int>),
+		"a single connection does not cost a whole signal");
+	{
+		signal_type single;
+		counter_type first, second;
+		connection kept = single.connect(&first, &counter_type::onValue);
+		single(1);
+		assert(first.m_sum == 1 && single.connected(kept));
+
+		signal_type copy(single);
+		copy(2);
+		assert(first.m_sum == 3 && copy.connected(kept));
+
+		single.connect(&second, &counter_type::onValue);
+		single(3);
+		assert(first.m_sum == 6 && second.m_sum == 3 && single.connected(kept));
+		assert(single.disconnect(kept) && !single.connected(kept));
+		assert(copy.disconnect(kept) && !copy.has_receivers());
+	}
+
+	// A handle spent before the promotion is not reissued after it.
+	{
+		signal_type spent;
+		connection old = spent.connect([](int) {});
+		assert(spent.disconnect(old) && !spent.disconnect(old) && !spent.has_receivers());
+		connection fresh = spent.connect([&calls](int) { ++calls; });
+		assert(spent.connected(fresh) && !spent.connected(old) && !spent.disconnect(old));
+	}
+
+	// A receiver held by the record goes away, is copied and is moved.
+	{
+		signal_type held;
+		{
+			counter_type gone;
+			held.connect(&gone, &counter_type::onValue);
+		}
+		held(1);
+		assert(!held.has_receivers());
+	}
+	{
+		signal_type held;
+		counter_type original;
+		held.connect(&original, &counter_type::onValue);
+		counter_type copied(original);
+		counter_type moved(std::move(original));
+		held(2);
+		assert(original.m_sum == 0 && copied.m_sum == 2 && moved.m_sum == 2);
+	}
+
+	// A slot that promotes its own signal, then disconnects itself, is still running.
+	{
+		signal_type rewired;
+		connection self;
+		int later = 0;
+		int ran = 0;
+		self = rewired.connect([&rewired, &self, &later, &ran](int) {
+			rewired.connect([&later](int) { ++later; });
+			rewired.disconnect(self);
+			++ran;
+		});
+		rewired(1);
+		assert(ran == 1 && later == 0 && !rewired.connected(self));
+		rewired(1);
+		assert(ran == 1 && later == 1);
+	}
+
+	// copy_on_write records call the slot unlocked and can be waited out.
+	{
+		basic_compact_signals<copy_on_write<multi_threaded_local>, int> cow;
+		counter_type receiver;
+		cow.connect(&receiver, &counter_type::onValue);
+		cow(2);
+		receiver.disconnect_all_and_wait();
+		cow(3);
+		assert(receiver.m_sum == 2 && !cow.has_receivers());
+	}
+
+	// Emissions racing the promotion still reach the first connection.
+	{
+		signal_type raced;
+		SharedCounter<multi_threaded_local> first, second;
+		raced.connect(&first, &SharedCounter<multi_threaded_local>::onValue);
+		std::thread emitter([&raced] {
+			for (int i = 0; i < 1000; ++i) {
+				raced(1);
+			}
+		});
+		raced.connect(&second, &SharedCounter<multi_threaded_local>::onValue);
+		emitter.join();
+		assert(first.m_sum == 1000);
+	}
+
+	// An empty signal converts nothing, compact or not.
+	Payload::s_copies = 0;
+	Payload payload("unused");
+	basic_compact_signals<multi_threaded_local, Payload>().emit(payload);
+	basic_signals<multi_threaded_local, Payload> empty;
+	empty(payload);
+	empty.connect([](const Payload&) {});
+	empty.disconnect_all();
+	empty(payload);
+	assert(Payload::s_copies == 0);
+}
+
+void test_emit_lazy()
+{
+	typedef basic_signals<multi_threaded_local, int, std::string> signal_type;
+	signal_type sig;
+	int built = 0;
+	auto factory = [&built] {
+		++built;
+		return std::make_tuple(built, std::string(100, 'x'));
+	};
+
+	// Nobody listening: the arguments are never built.
+	assert(!sig.has_receivers());
+	sig.emit_lazy(factory);
+	assert(built == 0);
+
+	Inbox inbox;
+	connection handle = sig.connect(&inbox, &Inbox::onMessage);
+	assert(sig.has_receivers());
+	sig.emit_lazy(factory);
+	assert(built == 1 && inbox.m_values.size() == 1 && inbox.m_last.size() == 100);
+
+	sig.disconnect(handle);
+	assert(!sig.has_receivers());
+	sig.emit_lazy(factory);
+	assert(built == 1);
+
+	// Slots taking by value get the built arguments moved in.
+	signals<Payload> payloads;
+	PayloadSink sink;
+	payloads.emit_lazy([] { return std::make_tuple(Payload("unused")); });
+	payloads.connect(&sink, &PayloadSink::byValue);
+	Payload::s_copies = 0;
+	payloads.emit_lazy([] { return std::make_tuple(Payload("built")); });
+	assert(sink.m_last == "built" && Payload::s_copies == 0);
+
+	basic_compact_signals<multi_threaded_local, int, std::string> compact;
+	assert(!compact.has_receivers());
+	compact.emit_lazy(factory);
+	compact.connect(&inbox, &Inbox::onMessage);
+	assert(compact.has_receivers());
+	compact.emit_lazy(factory);
+	assert(built == 2 && inbox.m_values.size() == 2);
+}
+
+struct Ranked : public basic_has_slots<multi_threaded_local>
+{
+	std::vector<int>* m_order;
+	int m_rank;
+
+	Ranked(std::vector<int>* order, int rank)
+		: m_order(order), m_rank(rank)
+	{}
+
+	void onEvent(int) {
+		m_order->push_back(m_rank);
+	}
+};
+
+template<class mt_policy>
+void test_priority_policy()
+{
+	typedef basic_signals<mt_policy, int> signal_type;
+	signal_type sig;
+	std::vector<int> order;
+	Ranked strategy(&order, 0);
+	Ranked risk(&order, 10);
+	Ranked late(&order, -5);
+
+	// Higher priorities first; equal ones in connection order.
+	sig.connect(&strategy, &Ranked::onEvent);
+	sig.connect([&order](int) { order.push_back(1); }, priority(1));
+	sig.connect(&late, &Ranked::onEvent, priority(-5));
+	sig.connect(&risk, &Ranked::onEvent, priority(10));
+	connection second = sig.connect([&order](int) { order.push_back(2); }, priority(1));
+	sig(0);
+
+	int expected[] = { 10, 1, 2, 0, -5 };
+	assert(order == std::vector<int>(expected, expected + 5));
+
+	// Handles still find their connections after the list shifted.
+	assert(sig.disconnect(second));
+	order.clear();
+	sig(0);
+	int remaining[] = { 10, 1, 0, -5 };
+	assert(order == std::vector<int>(remaining, remaining + 4));
+
+	// Copies keep the order.
+	signal_type copy(sig);
+	order.clear();
+	copy(0);
+	assert(order == std::vector<int>(remaining, remaining + 4));
+}
+
+void test_priorities()
+{
+	test_priority_policy<multi_threaded_local>();
+	test_priority_policy<copy_on_write<multi_threaded_local> >();
+
+	// Connected by a slot mid-emission: not called until the next one, then in place.
+	basic_signals<multi_threaded_local, int> sig;
+	std::vector<int> order;
+	connection urgent;
+	sig.connect([&](int) {
+		order.push_back(0);
+		if (!urgent.valid()) {
+			urgent = sig.connect([&order](int) { order.push_back(5); }, priority(5));
+		}
+	});
+	sig.connect([&order](int) { order.push_back(-1); }, priority(-1));
+	sig(0);
+	assert(order.size() == 2 && order[0] == 0 && order[1] == -1);
+
+	order.clear();
+	sig(0);
+	assert(order.size() == 3 && order[0] == 5 && order[1] == 0 && order[2] == -1);
+	assert(sig.disconnect(urgent));
+
+	// Compact signals pass the priority through.
+	basic_compact_signals<multi_threaded_local, int> compact;
+	order.clear();
+	compact.connect([&order](int) { order.push_back(0); });
+	compact.connect([&order](int) { order.push_back(3); }, priority(3));
+	compact(0);
+	assert(order.size() == 2 && order[0] == 3);
+
+	// So do conflated connections: their calls are posted in priority order.
+	dispatcher queue;
+	basic_signals<multi_threaded_local, int> quotes;
+	Ranked background(&order, 0);
+	Ranked keyed(&order, 4);
+	Ranked urgent_latest(&order, 7);
+	quotes.connect_latest(&background, &Ranked::onEvent, queue);
+	quotes.connect_latest(&keyed, &Ranked::onEvent, queue, [](int value) { return value; }, priority(4));
+	quotes.connect_latest(&urgent_latest, &Ranked::onEvent, queue, priority(7));
+	order.clear();
+	quotes(0);
+	assert(queue.dispatch() == 3);
+	int posted[] = { 7, 4, 0 };
+	assert(order == std::vector<int>(posted, posted + 3));
+}
+
+struct Position : public basic_has_slots<multi_threaded_local>
+{
+	std::atomic<int> m_value{0};
+	std::thread::id m_thread;
+
+	void onRevalue(int value)
+	{
+		m_value += value;
+		m_thread = std::this_thread::get_id();
+	}
+};
+
+// Forwards to a second signal, which under the default policy means taking the global
+// lock from the pool's threads.
+struct Relay : public has_slots
+{
+	signals<int>* m_next = nullptr;
+
+	void onValue(int value) {
+		(*m_next)(value);
+	}
+};
+
+struct Tally : public has_slots
+{
+	std::atomic<int> m_sum{0};
+
+	void onValue(int value) {
+		m_sum += value;
+	}
+};
+
+template<class mt_policy>
+void test_parallel_policy(thread_pool& pool)
+{
+	basic_signals<mt_policy, int> sig;
+	std::vector<Position> positions(5000);
+
+	for (std::size_t i = 0; i < positions.size(); ++i) {
+		sig.connect(&positions[i], &Position::onRevalue);
+	}
+
+	sig.emit_parallel(pool, 2);
+	sig.emit_parallel(pool, 3);
+
+	for (std::size_t i = 0; i < positions.size(); ++i) {
+		assert(positions[i].m_value == 5);
+	}
+}
+
+void test_parallel_emit()
+{
+	thread_pool pool(3, 100, 64);
+	assert(pool.size() == 3 && pool.threshold() == 100);
+
+	test_parallel_policy<multi_threaded_local>(pool);
+	test_parallel_policy<copy_on_write<multi_threaded_local> >(pool);
+
+	// Below the threshold, everything runs inline on the calling thread.
+	basic_signals<multi_threaded_local, int> small;
+	std::vector<Position> few(10);
+
+	for (std::size_t i = 0; i < few.size(); ++i) {
+		small.connect(&few[i], &Position::onRevalue);
+	}
+
+	small.emit_parallel(pool, 1);
+	for (std::size_t i = 0; i < few.size(); ++i) {
+		assert(few[i].m_value == 1 && few[i].m_thread == std::this_thread::get_id());
+	}
+
+	// A slot's exception reaches the emitter once every chunk has run.
+	basic_signals<multi_threaded_local, int> failing;
+	std::atomic<int> calls(0);
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		failing.connect([&calls, i](int value) {
+			++calls;
+			if (value == 0 && i == 500) {
+				throw std::runtime_error("slot failed");
+			}
+		});
+	}
+
+	bool thrown = false;
+
+	try {
+		failing.emit_parallel(pool, 0);
+	}
+	catch (const std::runtime_error&) {
+		thrown = true;
+	}
+
+	assert(thrown && calls > 500 && calls <= 1000);
+
+	calls = 0;
+	failing.emit_parallel(pool, 1);
+	assert(calls == 1000);
+
+	// Locked signals do not hold their lock while the pool runs, so slots may take it,
+	// as every slot does under multi_threaded_global.
+	signals<int> fan_out;
+	signals<int> next;
+	Tally tally;
+	std::vector<Relay> relays(1000);
+	next.connect(&tally, &Tally::onValue);
+
+	for (std::size_t i = 0; i < relays.size(); ++i)
+	{
+		relays[i].m_next = &next;
+		fan_out.connect(&relays[i], &Relay::onValue);
+	}
+
+	fan_out.emit_parallel(pool, 1);
+	assert(tally.m_sum == 1000);
+
+	// Slots may change the signal itself too; connections made meanwhile join the next
+	// emission, and a receiver dropped meanwhile is not called once its disconnect returns.
+	std::atomic<int> added(0);
+	fan_out.connect([&fan_out, &added](int value) {
+		if (value == 2) {
+			fan_out.connect([&added](int) { ++added; });
+		}
+	});
+
+	relays[0].disconnect_all_and_wait();
+	fan_out.emit_parallel(pool, 2);
+	assert(tally.m_sum == 1000 + 999 * 2 && added == 0);
+	fan_out.emit_parallel(pool, 3);
+	assert(tally.m_sum == 1000 + 999 * 5 && added == 1);
+}
+
+struct RiskCheck : public basic_has_slots<multi_threaded_local>
+{
+	int m_limit;
+	int m_calls;
+
+	explicit RiskCheck(int limit)
+		: m_limit(limit), m_calls(0)
+	{}
+
+	bool onOrder(int quantity)
+	{
+		++m_calls;
+		return quantity > m_limit;
+	}
+
+	int onQuote(const int& price) {
+		return price + m_limit;
+	}
+};
+
+struct Multiply
+{
+	int operator()(int accumulated, int value) const {
+		return accumulated * value;
+	}
+};
+
+template<class mt_policy>
+void test_combiner_policy()
+{
+	// The default keeps the last result, in priority order.
+	basic_combining_signals<mt_policy, int(int)> last;
+	assert(!last.has_receivers() && last(1) == 0);
+	last.connect([](int x) { return x + 1; }, priority(1));
+	last.connect([](int x) { return x * 10; });
+	assert(last.has_receivers() && last(2) == 20);
+
+	basic_combining_signals<mt_policy, int(int), first_value<int> > first;
+	first.connect([](int x) { return x + 1; }, priority(1));
+	first.connect([](int x) { return x * 10; });
+	assert(first(2) == 3);
+
+	basic_combining_signals<mt_policy, int(int), sum_of<int> > sum;
+	basic_combining_signals<mt_policy, int(int), min_of<int> > low;
+	basic_combining_signals<mt_policy, int(int), max_of<int> > high;
+	assert(sum(1) == 0 && low(1) == 0 && high(1) == 0);
+
+	RiskCheck checks[] = { RiskCheck(5), RiskCheck(-3), RiskCheck(8) };
+	for (RiskCheck& check : checks)
+	{
+		sum.connect(&check, &RiskCheck::onQuote);
+		low.connect(&check, &RiskCheck::onQuote);
+		high.connect(&check, &RiskCheck::onQuote);
+	}
+
+	assert(sum(100) == 310 && low(100) == 97 && high(100) == 108);
+
+	// Disconnecting a receiver takes its results out of the fold.
+	checks[1].disconnect_all();
+	assert(sum(100) == 213 && low(100) == 105);
+
+	// A pre-trade veto: the first check that objects stops the rest from running.
+	basic_combining_signals<mt_policy, bool(int), any_true> veto;
+	assert(!veto(1000));
+
+	RiskCheck gates[] = { RiskCheck(100), RiskCheck(10), RiskCheck(1) };
+	for (RiskCheck& gate : gates) {
+		veto.connect(&gate, &RiskCheck::onOrder);
+	}
+
+	assert(!veto(1));
+	assert(gates[0].m_calls == 1 && gates[1].m_calls == 1 && gates[2].m_calls == 1);
+	assert(veto(50));
+	assert(gates[0].m_calls == 2 && gates[1].m_calls == 2 && gates[2].m_calls == 1);
+
+	basic_combining_signals<mt_policy, bool(int), all_true> approve;
+	int calls = 0;
+	assert(approve(0));
+	approve.connect([&calls](int x) { ++calls; return x > 0; });
+	approve.connect([&calls](int x) { ++calls; return x > 10; });
+	assert(approve(20) && calls == 2);
+	assert(!approve(-1) && calls == 3);
+
+	basic_combining_signals<mt_policy, int(int), reducer<int, Multiply> > product((reducer<int, Multiply>(1)));
+	assert(product(3) == 1);
+	product.connect([](int x) { return x; });
+	product.connect([](int x) { return x + 1; });
+	assert(product(3) == 12);
+
+	// Copies keep the slots and the combiner's initial state.
+	basic_combining_signals<mt_policy, int(int), reducer<int, Multiply> > copy(product);
+	assert(copy(4) == 20);
+
+	basic_combining_signals<mt_policy, int(int), reducer<int, Multiply> > moved(std::move(copy));
+	assert(moved(4) == 20);
+}
+
+void test_combiners()
+{
+	test_combiner_policy<multi_threaded_local>();
+	test_combiner_policy<copy_on_write<multi_threaded_local> >();
+
+	// A slot may return anything the combiner takes.
+	combining_signals<long(int), sum_of<long> > total;
+	total.connect([](int x) { return static_cast<short>(x); });
+	total.connect([](int x) { return x * 2; });
+	assert(total(5) == 15);
+}
+
+int main()
+{
+	Sender sender;
+	Receiver rec;
+	sender.signalSender.connect(&rec, &Receiver::onReceiver);
+
+	sender.help1();
+	sender.help2();
+	assert(rec.m_count == 2);
+
+	sender.signalSender.disconnect(&rec);
+	sender.help1();
+	assert(rec.m_count == 2);
+
+	test_policy<single_threaded>();
+	test_policy<multi_threaded_global>();
+	test_policy<multi_threaded_local>();
+	test_policy<multi_threaded_striped>();
+	test_policy<multi_threaded_spin>();
+	test_policy<multi_threaded_adaptive>();
+#if __cplusplus >= 201703L
+	test_policy<multi_threaded_shared>();
+#endif
+	test_lock_policies();
+	test_fan_out();
+	test_delegates();
+	test_handles();
+	test_teardown();
+	test_argument_passing();
+	test_memory_resource();
+	test_copy_on_write();
+	test_epoch_reclamation();
+	test_queued_connections();
+	test_conflated_connections();
+	test_callables();
+	test_deferred_release();
+	test_disconnect_and_wait();
+	test_emit_batch();
+	test_static_signal();
+	test_move_semantics();
+	test_compact_signals();
+	test_emit_lazy();
+	test_priorities();
+	test_combiners();
+	test_parallel_emit();
+
+	return 0;
+}